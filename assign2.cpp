@@ -1,436 +1,667 @@
 #include <iostream>
-#include <fstream>
-#include <sstream>
-
-#include "bintree.h"
+#include <string.h>
+#include <vector>
+#include <thread>
+
+#include "maze.h"
+#include "compactmaze.h"
+#include "mazegrid.h"
+#include "jumppoint.h"
+#include "gridbfs.h"
+#include "griddijkstra.h"
+#include "gridmulti.h"
+#include "solverengine.h"
+#include "solutioncache.h"
+#include "tracebuffer.h"
+#include "memstats.h"
+#include "bitmaze.h"
+#include "outofcore.h"
 
 using namespace std;
 
-class MazePoint
+template <typename GridType, typename SolverType>
+void reportGridMemory(MemoryReport *report, const GridType &grid, 
+                      const SolverType &solver)
 {
-   private:
-   char value;
-   int x;
-
-   public:
-      
-   MazePoint()
+   /*The grid copy and the solver's state are added and the
+   report printed while both are still alive, unless report
+   is NULL*/
+   if (report != NULL)
    {
-      value = ' ';
-      x = 0;
+      report->add("grid", grid.memoryUsed());
+      report->add("solver", solver.memoryUsed());
+      report->print(cerr);
    }
+}
 
-   MazePoint(int i)
+void solveWithJumpPoints(const Maze &maze, MemoryReport *report)
+{
+   /*Solve on a flat grid with jump point search
+   and print it the same way printMaze does*/
+   MazeGrid grid;
+   maze.copyToGrid(grid);
+
+   int startX = 0, startY = 0, finishX = 0, finishY = 0;
+   grid.findCell('s', startX, startY);
+   grid.findCell('f', finishX, finishY);
+
+   JumpPointSolver solver(grid);
+   vector<GridPoint> path;
+   if (solver.solve(startX, startY, finishX, finishY, path))
    {
-      value = ' ';
-      x = i;
+      grid.markPath(path);
    }
+   grid.print();
+   reportGridMemory(report, grid, solver);
+}
 
-   char getValue() const
+template <typename GridType> void solveWithBfs(const Maze &maze, MemoryReport *report)
+{
+   /*Breadth first search on a flat grid stored in
+   GridType's layout*/
+   GridType grid;
+   maze.copyToGrid(grid);
+
+   int startX = 0, startY = 0, finishX = 0, finishY = 0;
+   grid.findCell('s', startX, startY);
+   grid.findCell('f', finishX, finishY);
+
+   GridBfsSolver<GridType> solver(grid);
+   vector<GridPoint> path;
+   if (solver.solve(startX, startY, finishX, finishY, path))
    {
-      return value;
+      grid.markPath(path);
    }
-      
-   void setValue(char c)
+   grid.print();
+   reportGridMemory(report, grid, solver);
+}
+
+template <typename GridType> 
+void solveWithDijkstra(const Maze &maze, MemoryReport *report)
+{
+   /*Least cost path where digit cells cost their value
+   to cross, on a flat grid stored in GridType's layout*/
+   GridType grid;
+   maze.copyToGrid(grid);
+
+   int startX = 0, startY = 0, finishX = 0, finishY = 0;
+   grid.findCell('s', startX, startY);
+   grid.findCell('f', finishX, finishY);
+
+   GridDijkstraSolver<GridType> solver(grid);
+   vector<GridPoint> path;
+   if (solver.solve(startX, startY, finishX, finishY, path))
    {
-      value = c;
+      grid.markPath(path);
    }
+   grid.print();
+   reportGridMemory(report, grid, solver);
+}
 
-   int getX() const
+template <typename GridType> void solveMultiple(const Maze &maze, MemoryReport *report)
+{
+   /*One search out from every finish gives the nearest
+   finish to each start. The start with the shortest
+   way out has its path marked, then every start is
+   listed with where it gets out.*/
+   GridType grid;
+   maze.copyToGrid(grid);
+
+   vector<GridPoint> starts, finishes;
+   grid.findCells('s', starts);
+   grid.findCells('f', finishes);
+
+   GridMultiSolver<GridType> solver(grid);
+   solver.solve(finishes, starts);
+
+   int best = -1;
+   for (unsigned int i = 0; i < starts.size(); i++)
    {
-      return x;
+      if (solver.reached(starts[i]) && (best < 0 || 
+            solver.distance(starts[i]) < solver.distance(starts[best])))
+      {
+         best = i;
+      }
    }
 
-   //overloaded operators
-
-   bool operator < (const MazePoint &other) const
+   if (best >= 0)
    {
-      return x < other.x;
+      vector<GridPoint> path;
+      solver.pathFrom(starts[best], path);
+      grid.markPath(path);
    }
+   grid.print();
 
-   bool operator == (const MazePoint &other) const
+   for (unsigned int i = 0; i < starts.size(); i++)
    {
-      return x == other.x;
+      cout << "Start (" << starts[i].x << ", " << starts[i].y << ") ";
+      if (solver.reached(starts[i]))
+      {
+         const GridPoint &exit = finishes[solver.nearestFinish(starts[i])];
+         cout << "to finish (" << exit.x << ", " << exit.y << ") in " 
+              << solver.distance(starts[i]) << " steps";
+         if ((int)i == best)
+         {
+            cout << ", best";
+         }
+      }
+      else
+      {
+         cout << "has no way out";
+      }
+      cout << "\n";
    }
-};
+   reportGridMemory(report, grid, solver);
+}
 
-class MazeRow
+template <typename GridType, typename Connectivity, typename Order, 
+          typename Visited> 
+void solveWithEngine(const Maze &maze, MemoryReport *report)
 {
-   private:
-   bintree<MazePoint> mazePoints;
-   int y;
+   /*Depth first search on a flat grid with the engine
+   built for these policies*/
+   GridType grid;
+   maze.copyToGrid(grid);
+
+   int startX = 0, startY = 0, finishX = 0, finishY = 0;
+   grid.findCell('s', startX, startY);
+   grid.findCell('f', finishX, finishY);
+
+   SolverEngine<GridType, Connectivity, Order, Visited> solver(grid);
+   vector<GridPoint> path;
+   if (solver.solve(startX, startY, finishX, finishY, path))
+   {
+      grid.markPath(path);
+   }
+   grid.print();
+   reportGridMemory(report, grid, solver);
+}
 
-   public:
+/*The engine flags are turned into template arguments one 
+at a time, each step picks one policy and passes the 
+choice on to the next*/
 
-   MazeRow()
+template <typename GridType, typename Connectivity, typename Order>
+void pickVisited(const Maze &maze, const string &visited, MemoryReport *report)
+{
+   if (visited == "bits")
    {
-      y = 0;
+      solveWithEngine<GridType, Connectivity, Order, BitVisited>(maze, report);
    }
-      
-   MazeRow(int i)
+   else
    {
-      y = i;
+      solveWithEngine<GridType, Connectivity, Order, ByteVisited>(maze, report);
    }
+}
 
-   int getY() const
+template <typename GridType, typename Connectivity>
+void pickOrder(const Maze &maze, const string &order, const string &visited,
+               MemoryReport *report)
+{
+   if (order == "rdlu")
    {
-      return y;
+      pickVisited<GridType, Connectivity, RightDownLeftUp>(maze, visited, report);
    }
-   
-   int rowLength() const
+   else
    {
-      return mazePoints.size();
+      pickVisited<GridType, Connectivity, DownUpRightLeft>(maze, visited, report);
    }
+}
 
-   string toString() const
+template <typename GridType>
+void pickConnectivity(const Maze &maze, const string &connect,
+                      const string &order, const string &visited,
+                      MemoryReport *report)
+{
+   if (connect == "8")
+   {
+      pickOrder<GridType, EightConnected>(maze, order, visited, report);
+   }
+   else
    {
-      //prints out each MazePoint in this MazeRow
-      stringstream ss;
+      pickOrder<GridType, FourConnected>(maze, order, visited, report);
+   }
+}
 
-      for (int i = 0; i < mazePoints.size(); i++)
-      {
-         MazePoint mP(i);
-         const MazePoint *mPoint = mazePoints.findConst(mP);
-         if (mPoint != NULL)
-         {
-            mP.setValue(mPoint->getValue());
-         }
-         ss << mP.getValue();
-      }
-      return ss.str();
+void solveWithBitPlanes(const char *mazeFile, MemoryReport *report)
+{
+   /*Load straight into bit planes, the tree is never built
+   so this works on mazes far too big for it*/
+   BitMaze bitMaze;
+   bitMaze.loadMaze(mazeFile);
+   bitMaze.checkMaze(mazeFile);
+
+   vector<GridPoint> path;
+   if (bitMaze.solve(path))
+   {
+      bitMaze.markPath(path);
    }
+   bitMaze.printMaze();
 
-   char searchMazePoint(int x) const
+   if (report != NULL)
    {
-      /*Used for searching for a specific MazePoint
-      using its x coordinate.*/
-      char c;
+      bitMaze.reportMemory(*report);
+      report->print(cerr);
+   }
+}
 
-      MazePoint mP(x);
-      const MazePoint *mPoint = mazePoints.findConst(mP);
-      if (mPoint != NULL)
-      {
-         mP.setValue(mPoint->getValue());
-         c = mP.getValue();
-      }
+void solveCompact(const char *mazeFile, MemoryReport *report)
+{
+   /*The same search as dfs on a byte per cell, the maze
+   is never built into trees*/
+   CompactMaze compact;
+   compact.loadMaze(mazeFile);
+   compact.checkMaze(mazeFile);
+   compact.solve();
+   compact.printMaze();
+
+   if (report != NULL)
+   {
+      compact.reportMemory(*report);
+      report->print(cerr);
+   }
+}
+
+void solveOutOfCore(const char *mazeFile, size_t budgetBytes, MemoryReport *report)
+{
+   /*Keep the maze on disk and solve it in bands that
+   fit in budgetBytes of memory*/
+   OutOfCoreMaze bigMaze(budgetBytes);
+   bigMaze.loadMaze(mazeFile);
+   bigMaze.checkMaze();
+   bigMaze.solve();
+   bigMaze.printMaze();
+
+   if (report != NULL)
+   {
+      bigMaze.reportMemory(*report);
+      report->print(cerr);
+   }
+}
 
-      return c;
+struct SolveOptions
+{
+   string solver, layout, connect, order, visited;
+   long budgetMB;
+   int numThreads;
+   long stepSize;
+   string traceFile;
+   int traceBits;
+   bool memStats;
+
+   string mode() const
+   {
+      //the options that change the output, budget and
+      //threads only change how it is worked out
+      return solver + " " + layout + " " + connect + " " + order + " " + visited;
    }
-   
-   void changeMazePoint(const int x, const char &c)
+};
+
+void solveWithTree(Maze &maze, const SolveOptions &options, MemoryReport *report)
+{
+   /*The recursive search on the trees the maze was loaded
+   into, with a trace, in steps or all at once*/
+   if (!options.traceFile.empty())
    {
-      /*Used to mark the maze with breadcrumbs
-      and the actual path.*/
-      MazePoint mP(x);
+      RingTracer tracer(options.traceBits);
+      maze.findPathThroughMaze(tracer);
+      maze.printMaze();
 
-      MazePoint *mPoint = mazePoints.find(mP);
-      if (mPoint != NULL)
+      if (!tracer.write(options.traceFile.c_str()))
       {
-         char sc = mPoint->getValue();
-
-         if (sc != 's')
-         {
-            mP.setValue(c);
-            mazePoints.erase(mP);
-            mazePoints.insert(mP);
-         }
+         cerr << "Unable to write trace " << options.traceFile << "\n";
       }
    }
-   
-   void insertMazePointsIntoRow(const string &line)
+   else if (report != NULL)
    {
-      /*Will only insert a char into the MazeRow
-      if it is a '#', ' ', 's', 'f' or '\n'.
-      Otherwise it returns an error and exits the program.*/
-      for(unsigned int i = 0; i <line.length(); i++)
+      //the recursion of move is the solver's memory
+      StackTracer tracer;
+      maze.findPathThroughMaze(tracer);
+      maze.printMaze();
+      report->add("solver stack", tracer.peakBytes());
+   }
+   else if (options.stepSize > 0)
+   {
+      MazeSolveTask task(maze);
+      while (task.step(options.stepSize) == MazeSolveTask::running)
       {
-         if (line[i] == '#' || line[i] == ' ' || line[i] == 's' || 
-                  line[i] == 'f' || line[i] == '\n')
-         {
-            MazePoint mazePoint(i);
-            mazePoint.setValue(line[i]);
-            mazePoints.insert(mazePoint);
-         } 
-         else
-         {
-            cout << "Invalid character in maze\n";
-            exit(0);
-         }
       }
+      maze.printMaze();
+   }
+   else
+   {
+      maze.findPathThroughMaze();
+      maze.printMaze();
    }
 
-   //overloaded operators
+   if (report != NULL)
+   {
+      report->print(cerr);
+   }
+}
 
-   bool operator < (const MazeRow &other) const
+void runSolver(const SolveOptions &options, const char *mazeFile, 
+               MemoryReport *report)
+{
+   /*Load, check, solve and print the maze. Each solver adds the structures it still holds once
+   the maze is solved to report and prints it while they
+   are alive, unless report is NULL.*/
+   const string &solver = options.solver;
+   const string &layout = options.layout;
+
+   if (solver == "compact")
    {
-      return y < other.y;
+      solveCompact(mazeFile, report);
+      return;
    }
 
-   bool operator == (const MazeRow &other) const
+   if (solver == "bitplane")
    {
-      return y == other.y;
+      solveWithBitPlanes(mazeFile, report);
+      return;
    }
-};
 
-class Maze
-{
-   private:
-   bintree<MazeRow> mazeRows;
-   int startX, startY, finishX, finishY;
+   if (solver == "outofcore")
+   {
+      solveOutOfCore(mazeFile, (size_t)options.budgetMB << 20, report);
+      return;
+   }
 
-   public:
+   Maze maze;
+   maze.loadMaze(mazeFile, options.numThreads);
+   maze.checkMaze(mazeFile, solver == "multi");
 
-   void loadMaze(const char *filename)
+   if (report != NULL)
    {
-      string line;
-      ifstream fin;
+      maze.reportMemory(*report);
+   }
 
-      fin.open(filename);
-      if (fin == NULL)
-      {
-         cout << "Unable to load maze " << filename << "\n";
-         exit(0);
-      }
+   if (solver == "engine" && layout == "tiled")
+   {
+      pickConnectivity<TiledMazeGrid>(maze, options.connect, options.order, 
+                                      options.visited, report);
+   }
+   else if (solver == "engine")
+   {
+      pickConnectivity<MazeGrid>(maze, options.connect, options.order, 
+                                 options.visited, report);
+   }
+   else if (solver == "jps")
+   {
+      solveWithJumpPoints(maze, report);
+   }
+   else if (solver == "bfs" && layout == "tiled")
+   {
+      solveWithBfs<TiledMazeGrid>(maze, report);
+   }
+   else if (solver == "bfs")
+   {
+      solveWithBfs<MazeGrid>(maze, report);
+   }
+   else if (solver == "multi" && layout == "tiled")
+   {
+      solveMultiple<TiledMazeGrid>(maze, report);
+   }
+   else if (solver == "multi")
+   {
+      solveMultiple<MazeGrid>(maze, report);
+   }
+   else if (solver == "dijkstra" && layout == "tiled")
+   {
+      solveWithDijkstra<TiledMazeGrid>(maze, report);
+   }
+   else if (solver == "dijkstra")
+   {
+      solveWithDijkstra<MazeGrid>(maze, report);
+   }
+   else
+   {
+      solveWithTree(maze, options, report);
+   }
+}
 
-      int rowNumber = 0;
+void runCached(const SolveOptions &options, const char *mazeFile,
+               const string &cacheDir, long cacheMB)
+{
+   /*A maze already solved the same way is copied out of
+   the cache without being parsed. Otherwise it is solved
+   with the output copied to a file in the cache as it
+   goes, and stored if the run gets to the end. The maze
+   is hashed a block at a time and nothing is held in
+   memory for the cache, so the outofcore budget still
+   holds. Runs that stop on an error are never stored.*/
+   SolutionCache cache(cacheDir, (size_t)cacheMB << 20);
+
+   uint64_t key;
+   if (!SolutionCache::makeKey(mazeFile, options.mode(), key))
+   {
+      //the solver reports the file it can't read
+      runSolver(options, mazeFile, NULL);
+      return;
+   }
 
-      while (getline(fin, line) !=NULL)
-      {
-         insertRowsIntoTree(line, rowNumber);
-         rowNumber++;
-      }
+   if (cache.fetch(key, cout))
+   {
+      return;
+   }
+
+   string tmpPath = cache.tempPathFor(key);
+   filebuf copy;
+   if (copy.open(tmpPath.c_str(), ios::out | ios::binary) == NULL)
+   {
+      runSolver(options, mazeFile, NULL);
+      return;
+   }
+
+   teeBuffer tee(cout.rdbuf(), &copy);
+   streambuf *original = cout.rdbuf(&tee);
+   try
+   {
+      runSolver(options, mazeFile, NULL);
+   }
+   catch (...)
+   {
+      //put cout back for main to print the error
+      cout.flush();
+      cout.rdbuf(original);
+      copy.close();
+      remove(tmpPath.c_str());
+      throw;
    }
+   cout.flush();
+   cout.rdbuf(original);
 
-   void insertRowsIntoTree(const string &line, int rowNumber)
+   if (copy.close() != NULL && tee.copied())
    {
-      MazeRow mazeRow(rowNumber);
-      mazeRow.insertMazePointsIntoRow(line);
-      mazeRows.insert(mazeRow);
+      cache.store(key, tmpPath);
    }
+   else
+   {
+      remove(tmpPath.c_str());
+   }
+}
+
+int main(int argc, char *argv[])
+{
+   const char *mazeFile = NULL;
+   SolveOptions options;
+   options.solver = "dfs";
+   options.layout = "rowmajor";
+   options.connect = "4";
+   options.order = "dulr";
+   options.visited = "bytes";
+   options.budgetMB = 256;
+   options.numThreads = thread::hardware_concurrency();
+   options.stepSize = 0;
+   options.traceBits = 20;
+   options.memStats = false;
+   string cacheDir;
+   long cacheMB = 64;
    
-   void checkMaze(const char *mazeFile)
-   {
-      /*Check the maze
-      Number of start and finish should be equal to 1
-      Also checks if the start and finish points 
-      are located outside of the maze
-      
-      The (x,y) coordinates of the starting point
-      is saved for finding the path later*/
-      int numStart = 0 , numFinish = 0;
-
-      for (int y = 0; y <mazeRows.size(); y++)
+   /*Usage: assign2 [-solver dfs|engine|jps|bfs|dijkstra|multi|
+                           compact|bitplane|outofcore]
+                  [-layout rowmajor|tiled] [-budget megabytes] 
+                  [-threads n] [-connect 4|8] [-order dulr|rdlu]
+                  [-visited bytes|bits] [-cache dir] 
+                  [-cachesize megabytes] [-step moves] 
+                  [-trace file] [-tracebits n] [-memstats] mazefile
+   dfs is the original tree based depth first search.
+   engine is a depth first search built for the -connect,
+   -order and -visited flags, by default it finds the same
+   path as dfs. -step makes dfs run a given number of
+   moves at a time, the way a caller sharing its thread
+   would, with the same result. -trace makes dfs record
+   every move into file for tracereplay, keeping the last
+   2^tracebits of them. multi takes any number of starts and
+   finishes and finds the nearest finish to each start.
+   compact is dfs on a byte a cell, with its stack kept
+   in the cells, and gives the same output.
+   -memstats writes the bytes per cell of each structure
+   the solve holds and of the whole process to cerr.
+   The layout picks how the grid of the grid solvers is
+   stored, the budget caps the memory the outofcore solver
+   uses, a maze that can't be solved in it is an error,
+   and threads is how many threads load the maze, by
+   default one per core.
+   With -cache, solutions are kept in dir, up to cachesize
+   megabytes of them, and a maze solved before the same
+   way is printed straight from there.
+   Digits 1 to 9 in a maze are cells that cost that much
+   to cross. Only dijkstra walks on them, dfs, jps and
+   bfs treat them as walls and bitplane and outofcore
+   don't accept them.*/
+   for (int i = 1; i < argc; i++)
+   {
+      if (strcmp(argv[i], "-solver") == 0 && i + 1 < argc)
       {
-         MazeRow mR(y);
-         const MazeRow *mRow = mazeRows.findConst(mR);
-         if (mRow != NULL)
-         {
-            for (int x = 0; x < mRow->rowLength(); x++)
-            {
-               char c = mRow->searchMazePoint(x);
-
-               if (c == 's')
-               {
-                  numStart++;
-
-                  startX = x;
-                  startY = y;
-               }
-
-               if (c == 'f')
-               {
-                  numFinish++;
-
-                  finishX = x;
-                  finishY = y;
-               }
-            }
-         }
+         options.solver = argv[++i];
       }
-      
-      if (ifOutside('s', startX, startY) == true)
+      else if (strcmp(argv[i], "-layout") == 0 && i + 1 < argc)
       {
-         cout << "Error - start declared outside of maze\n";
-         cout << "Unable to load maze " << mazeFile << "\n";
-         exit(0);
+         options.layout = argv[++i];
       }
-      if (ifOutside('f', finishX, finishY) == true)
+      else if (strcmp(argv[i], "-budget") == 0 && i + 1 < argc)
       {
-         cout << "Error - finish declared outside of maze\n";
-         cout << "Unable to load maze " << mazeFile << "\n";
-         exit(0);
+         options.budgetMB = atol(argv[++i]);
       }
-      checkStart(numStart);
-      checkFinish(numFinish);
-   }
-   
-   void checkStart(int i)
-   {
-      if (i == 0)
+      else if (strcmp(argv[i], "-threads") == 0 && i + 1 < argc)
       {
-         cout << "Error - no start found in maze\n";
-         exit(0);
+         options.numThreads = atoi(argv[++i]);
       }
-
-      if (i > 1)
+      else if (strcmp(argv[i], "-connect") == 0 && i + 1 < argc)
       {
-         cout << "Error - multiple start found in maze\n";
-         exit(0);
+         options.connect = argv[++i];
       }
-   }
-   
-   void checkFinish(int i)
-   {
-      if (i == 0)
+      else if (strcmp(argv[i], "-order") == 0 && i + 1 < argc)
       {
-         cout << "Error - no finish found in maze\n";
-         exit(0);
+         options.order = argv[++i];
       }
-
-      if (i >1)
+      else if (strcmp(argv[i], "-visited") == 0 && i + 1 < argc)
       {
-         cout << "Error - multiple finish found in maze\n";
-         exit(0);
+         options.visited = argv[++i];
       }
-   }
-   
-   bool ifOutside(const char c, int x, int y)
-   {
-      /*Find position of character
-      Find the first hash in a line 
-      If no hash or the character is before a hash
-      then its outside.
-      
-      Assumes the maze is not U-shaped and
-      the spec says we don't have to check the right
-      of a maze*/
-      int i = 0;
-      int positionOfChar = x;
-      int positionOfHash = 0;
-
-      MazeRow mR(y);
-      const MazeRow *mRow = mazeRows.findConst(mR);
-      if (mRow != NULL)
+      else if (strcmp(argv[i], "-cache") == 0 && i + 1 < argc)
       {
-         while(mRow->searchMazePoint(i) != '#')
-         {
-            i++;
-            positionOfHash++;
-         }
+         cacheDir = argv[++i];
       }
-
-      if (positionOfChar < positionOfHash)
+      else if (strcmp(argv[i], "-cachesize") == 0 && i + 1 < argc)
       {
-         return true;
+         cacheMB = atol(argv[++i]);
       }
-
-      return false;
-   }
-   
-   void findPathThroughMaze()
-   {
-      //Give the starting point to the move function
-      move(startX, startY);
-   }
-   
-   bool move(int x, int y)
-   {
-      /*Check if on finishing point
-      If yes, return true all the way up the stack
-      Clean the maze up and change the path from spaces to a '.'
-      If not, move down, up, right, left and leave breadcrumb
-      */
-      if (x < 0 || y < 0)
+      else if (strcmp(argv[i], "-step") == 0 && i + 1 < argc)
+      {
+         options.stepSize = atol(argv[++i]);
+      }
+      else if (strcmp(argv[i], "-trace") == 0 && i + 1 < argc)
+      {
+         options.traceFile = argv[++i];
+      }
+      else if (strcmp(argv[i], "-tracebits") == 0 && i + 1 < argc)
+      {
+         options.traceBits = atoi(argv[++i]);
+      }
+      else if (strcmp(argv[i], "-memstats") == 0)
       {
-         return false;
+         options.memStats = true;
       }
+      else if (mazeFile == NULL)
+      {
+         mazeFile = argv[i];
+      }
+      else
+      {
+         mazeFile = NULL;
+         break;
+      }
+   }
 
-      MazeRow mR(y);
-      MazeRow *mRow = mazeRows.find(mR);
+   if (mazeFile == NULL)
+   {
+      cout << "Must supply 1 argument to this program\n";
+      return 0;
+   }
 
-      if (mRow != NULL)
-      {
-         char c = mRow->searchMazePoint(x);
+   const string &solver = options.solver;
+   if (solver != "dfs" && solver != "engine" && solver != "jps" && 
+         solver != "bfs" && solver != "dijkstra" && solver != "multi" &&
+         solver != "compact" && solver != "bitplane" && solver != "outofcore")
+   {
+      cout << "Unknown solver " << solver << "\n";
+      return 0;
+   }
 
-         if (c == 'f')
-         {
-            return true;
-         }
+   if (options.layout != "rowmajor" && options.layout != "tiled")
+   {
+      cout << "Unknown layout " << options.layout << "\n";
+      return 0;
+   }
 
-         if (c == ' ' || c == 's')
-         {
-            mRow->changeMazePoint(x, '!');
-
-            if (move(x, y+1) == true)
-            {
-               cleanUpMaze();
-               mRow->changeMazePoint(x, '.');
-               return true;
-            }
-            if (move(x, y-1) == true)
-            {
-               cleanUpMaze();
-               mRow->changeMazePoint(x, '.');
-               return true;
-            }
-            if (move(x+1, y) == true)
-            {
-               cleanUpMaze();
-               mRow->changeMazePoint(x, '.');
-               return true;
-            }
-            if (move(x-1, y) == true)
-            {
-               cleanUpMaze();
-               mRow->changeMazePoint(x, '.');
-               return true;
-            }
-         }
-      }
-      return false;
+   if (options.connect != "4" && options.connect != "8")
+   {
+      cout << "Unknown connectivity " << options.connect << "\n";
+      return 0;
    }
-   
-   void cleanUpMaze()
+
+   if (options.order != "dulr" && options.order != "rdlu")
    {
-      for (int y = 0; y < mazeRows.size(); y++)
-      {
-         MazeRow mR(y);
-         MazeRow *mRow = mazeRows.find(mR);
-         if (mRow != NULL)
-         {
-            for (int x = 0; x < mRow->rowLength(); x++)
-            {
-               char c = mRow->searchMazePoint(x);
-
-               if (c == '!')
-               {
-                  mRow->changeMazePoint(x, ' ');
-               }
-            }
-         }
-      }
+      cout << "Unknown order " << options.order << "\n";
+      return 0;
    }
-   
-   void printMaze() const
+
+   if (options.visited != "bytes" && options.visited != "bits")
    {
-      mazeRows.print();
+      cout << "Unknown visited storage " << options.visited << "\n";
+      return 0;
    }
-};
 
-int main(int argc, char *argv[])
-{
-   Maze maze;
-   
-   if (argc != 2)
+   if (options.traceBits < 1 || options.traceBits > 30)
    {
-      cout << "Must supply 1 argument to this program\n";
+      cout << "Trace bits must be from 1 to 30\n";
       return 0;
    }
-   
-   maze.loadMaze(argv[1]);
-   maze.checkMaze(argv[1]);
-   maze.findPathThroughMaze();
-   maze.printMaze();
+
+   try
+   {
+      //a traced or measured run always solves, the trace or
+      //the memory is what it's for
+      if (!cacheDir.empty() && options.traceFile.empty() && !options.memStats)
+      {
+         runCached(options, mazeFile, cacheDir, cacheMB);
+      }
+      else if (options.memStats)
+      {
+         MemoryReport report;
+         runSolver(options, mazeFile, &report);
+      }
+      else
+      {
+         runSolver(options, mazeFile, NULL);
+      }
+   }
+   catch (const MazeError &error)
+   {
+      cout << error.what();
+   }
    
    return 0;
 }
@@ -0,0 +1,252 @@
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <mutex>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "benchkeys.h"
+#include "bintree.h"
+#include "concurrentbintree.h"
+
+using namespace std;
+
+/*Reader and writer throughput of concurrentBintree against
+a bintree behind one mutex.
+
+Usage: benchconcurrent [-seconds n] [-keys n]
+
+A tree of n keys, 2^16 by default, each with a 256 byte
+payload like a row of a wide maze. For 1, 2 and 4 readers
+with no writer and then with one, every thread runs for
+n seconds, 1 by default. Readers look up random keys and
+read the payload, the writer erases and puts back random
+keys. Reads and writes are printed in millions a second
+for three trees
+   locked   a bintree of rows behind one mutex
+   copied   a concurrentBintree of rows, each write copies
+            the rows on its path and each read copies a row
+   shared   a concurrentBintree of sharedItems, only keys
+            and pointers are copied*/
+
+class Row
+{
+   private:
+      int key;
+      string cells;
+
+   public:
+      Row(int k = 0) : key(k), cells(256, ' ') {}
+
+      int getKey() const { return key; }
+      char firstCell() const { return cells[0]; }
+
+      bool operator < (const Row &other) const { return key < other.key; }
+      bool operator == (const Row &other) const { return key == other.key; }
+      bool operator <= (const Row &other) const { return key <= other.key; }
+      bool operator >= (const Row &other) const { return key >= other.key; }
+
+      string toString() const { return to_string(key); }
+};
+
+// lookups by the key alone
+bool operator < (int key, const Row &row) { return key < row.getKey(); }
+bool operator == (int key, const Row &row) { return key == row.getKey(); }
+
+typedef sharedItem<int, string> SharedRow;
+
+class LockedTree
+{
+   /*The obvious way to share a bintree, everything under
+   one lock*/
+   private:
+      bintree<Row> tree;
+      mutable mutex lock;
+
+   public:
+      void insert(const Row &row)
+      {
+         lock_guard<mutex> guard(lock);
+         tree.insert(row);
+      }
+
+      void erase(int key)
+      {
+         lock_guard<mutex> guard(lock);
+         tree.erase(Row(key));
+      }
+
+      bool read(int key) const
+      {
+         lock_guard<mutex> guard(lock);
+         const Row *row = tree.findConst(Row(key));
+         return (row != NULL && row->firstCell() == ' ');
+      }
+};
+
+class CopiedTree
+{
+   private:
+      concurrentBintree<Row> tree;
+
+   public:
+      void insert(const Row &row)
+      {
+         tree.insert(row);
+      }
+
+      void erase(int key)
+      {
+         tree.erase(key);
+      }
+
+      bool read(int key) const
+      {
+         Row row;
+         return (tree.find(key, row) && row.firstCell() == ' ');
+      }
+};
+
+class SharedTree
+{
+   private:
+      concurrentBintree<SharedRow> tree;
+
+   public:
+      void insert(const Row &row)
+      {
+         tree.insert(SharedRow(row.getKey(), string(256, ' ')));
+      }
+
+      void erase(int key)
+      {
+         tree.erase(key);
+      }
+
+      bool read(int key) const
+      {
+         SharedRow row;
+         return (tree.find(key, row) && row.payload()[0] == ' ');
+      }
+};
+
+template <typename TreeType>
+void run(int numKeys, int numReaders, int numWriters, int seconds,
+         double &readRate, double &writeRate)
+{
+   vector<int> keys;
+   scrambledKeys(numKeys, keys);
+
+   TreeType tree;
+   for (int i = 0; i < numKeys; i++)
+   {
+      tree.insert(Row(keys[i]));
+   }
+
+   atomic<bool> stop(false);
+   atomic<long> reads(0), writes(0), found(0);
+   vector<thread> threads;
+
+   for (int r = 0; r < numReaders; r++)
+   {
+      threads.push_back(thread([&, r]()
+      {
+         unsigned int seed = r * 77 + 1;
+         long count = 0, hits = 0;
+         while (!stop.load(memory_order_relaxed))
+         {
+            seed = seed * 1103515245 + 12345;
+            if (tree.read((seed >> 8) % numKeys)) hits++;
+            count++;
+         }
+         reads += count;
+         found += hits;
+      }));
+   }
+
+   for (int w = 0; w < numWriters; w++)
+   {
+      threads.push_back(thread([&, w]()
+      {
+         unsigned int seed = w * 991 + 3;
+         long count = 0;
+         while (!stop.load(memory_order_relaxed))
+         {
+            seed = seed * 1103515245 + 12345;
+            int key = (seed >> 8) % numKeys;
+            tree.erase(key);
+            tree.insert(Row(key));
+            count += 2;
+         }
+         writes += count;
+      }));
+   }
+
+   this_thread::sleep_for(chrono::seconds(seconds));
+   stop.store(true);
+   for (size_t i = 0; i < threads.size(); i++)
+   {
+      threads[i].join();
+   }
+
+   readRate = reads.load() / (double)seconds / 1e6;
+   writeRate = writes.load() / (double)seconds / 1e6;
+}
+
+int main(int argc, char *argv[])
+{
+   int seconds = 1;
+   int numKeys = 1 << 16;
+
+   for (int i = 1; i < argc; i++)
+   {
+      if (strcmp(argv[i], "-seconds") == 0 && i + 1 < argc)
+      {
+         seconds = atoi(argv[++i]);
+      }
+      else if (strcmp(argv[i], "-keys") == 0 && i + 1 < argc)
+      {
+         numKeys = atoi(argv[++i]);
+      }
+      else
+      {
+         cout << "Usage: benchconcurrent [-seconds n] [-keys n]\n";
+         return 0;
+      }
+   }
+
+   if (seconds < 1 || numKeys < 1)
+   {
+      cout << "Usage: benchconcurrent [-seconds n] [-keys n]\n";
+      return 0;
+   }
+
+   cout << thread::hardware_concurrency() << " cores\n";
+   printf("%-8s %-8s %-8s %10s %10s %10s\n", "readers", "writers", "",
+          "locked", "copied", "shared");
+
+   static const int readerCounts[3] = { 1, 2, 4 };
+   for (int numWriters = 0; numWriters <= 1; numWriters++)
+   {
+      for (int i = 0; i < 3; i++)
+      {
+         double reads[3], writes[3];
+         run<LockedTree>(numKeys, readerCounts[i], numWriters, seconds, reads[0], writes[0]);
+         run<CopiedTree>(numKeys, readerCounts[i], numWriters, seconds, reads[1], writes[1]);
+         run<SharedTree>(numKeys, readerCounts[i], numWriters, seconds, reads[2], writes[2]);
+
+         printf("%-8d %-8d %-8s %10.2f %10.2f %10.2f\n", readerCounts[i], numWriters,
+                "reads", reads[0], reads[1], reads[2]);
+         if (numWriters > 0)
+         {
+            printf("%-8s %-8s %-8s %10.2f %10.2f %10.2f\n", "", "", "writes",
+                   writes[0], writes[1], writes[2]);
+         }
+      }
+   }
+   return 0;
+}
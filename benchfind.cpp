@@ -0,0 +1,116 @@
+#include <chrono>
+#include <iostream>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+#include "benchkeys.h"
+#include "bintree.h"
+
+using namespace std;
+
+/*Times bintree insert, find and erase on trees with
+millions of keys.
+
+Usage: benchfind [-keys n] [-finds n]
+
+Trees of 2^20 keys up to n keys, 2^22 by default, going
+up by 2 times at each step. The keys are inserted in a
+scrambled order, n finds of random keys, 2^22 by
+default, are looked up and then every other key is
+erased. Rates are printed in millions a second.
+
+To compare with the recursive find, insert and erase from
+before they were made loops, build it a second time next
+to the headers as they were then:
+   mkdir old
+   git archive 86f562f binnode.h bintree.h frozentree.h | tar -x -C old
+   cp benchfind.cpp benchkeys.h old
+   g++ -std=c++11 -O2 -o benchfind-old old/benchfind.cpp*/
+
+double secondsSince(chrono::steady_clock::time_point begin)
+{
+   chrono::duration<double> taken = chrono::steady_clock::now() - begin;
+   return taken.count();
+}
+
+int main(int argc, char *argv[])
+{
+   int maxKeys = 1 << 22;
+   int numFinds = 1 << 22;
+
+   for (int i = 1; i < argc; i++)
+   {
+      if (strcmp(argv[i], "-keys") == 0 && i + 1 < argc)
+      {
+         maxKeys = atoi(argv[++i]);
+      }
+      else if (strcmp(argv[i], "-finds") == 0 && i + 1 < argc)
+      {
+         numFinds = atoi(argv[++i]);
+      }
+      else
+      {
+         cout << "Usage: benchfind [-keys n] [-finds n]\n";
+         return 0;
+      }
+   }
+
+   if (maxKeys < (1 << 20) || numFinds < 1)
+   {
+      cout << "Usage: benchfind [-keys n] [-finds n]\n";
+      cout << "at least 1048576 keys\n";
+      return 0;
+   }
+
+   printf("%-10s %12s %12s %12s\n", "keys", "insert M/s", "find M/s", "erase M/s");
+   for (int numKeys = 1 << 20; numKeys <= maxKeys; numKeys *= 2)
+   {
+      vector<int> keys;
+      scrambledKeys(numKeys, keys);
+
+      bintree<Key> tree;
+      chrono::steady_clock::time_point begin = chrono::steady_clock::now();
+      for (int i = 0; i < numKeys; i++)
+      {
+         tree.insert(Key(keys[i]));
+      }
+      double insertTime = secondsSince(begin);
+
+      srand(numKeys);
+      vector<Key> finds(numFinds);
+      for (int i = 0; i < numFinds; i++)
+      {
+         finds[i] = Key(rand() % numKeys);
+      }
+
+      // every key is in the tree, a miss means a broken find
+      begin = chrono::steady_clock::now();
+      int missed = 0;
+      for (int i = 0; i < numFinds; i++)
+      {
+         if (tree.findConst(finds[i]) == NULL) missed++;
+      }
+      double findTime = secondsSince(begin);
+
+      begin = chrono::steady_clock::now();
+      for (int i = 0; i < numKeys; i += 2)
+      {
+         tree.erase(Key(i));
+      }
+      double eraseTime = secondsSince(begin);
+
+      char error[80];
+      if (missed > 0 || !tree.verifyTree(error) || tree.size() != numKeys / 2)
+      {
+         cout << "Tree broken after " << numKeys << " keys\n";
+         return 1;
+      }
+
+      printf("%-10d %12.2f %12.2f %12.2f\n", numKeys, numKeys / insertTime / 1e6,
+             numFinds / findTime / 1e6, numKeys / 2 / eraseTime / 1e6);
+   }
+   return 0;
+}
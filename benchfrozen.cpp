@@ -0,0 +1,106 @@
+#include <chrono>
+#include <iostream>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+#include "benchkeys.h"
+#include "bintree.h"
+
+using namespace std;
+
+/*Times find on a frozen tree against the pointer based AVL
+tree it was frozen from.
+
+Usage: benchfrozen [-keys n] [-finds n]
+
+Trees of 2^16 keys up to n keys, 2^24 by default, going
+up by 4 times at each step, are built with the keys
+inserted in a scrambled order so the nodes are spread
+over the heap the way loadMaze leaves them. The same
+random keys, n finds of them, 2^22 by default, are then
+looked up in the AVL tree and in the frozen copy of it.*/
+
+template <typename TreeType>
+double timeFinds(const TreeType &tree, const vector<Key> &finds, long &sum)
+{
+   chrono::steady_clock::time_point begin = chrono::steady_clock::now();
+
+   // the sum keeps the finds from being optimised away
+   sum = 0;
+   for (size_t i = 0; i < finds.size(); i++)
+   {
+      const Key *found = tree.findConst(finds[i]);
+      if (found != NULL) sum += found->getValue();
+   }
+
+   chrono::duration<double> taken = chrono::steady_clock::now() - begin;
+   return taken.count();
+}
+
+int main(int argc, char *argv[])
+{
+   int maxKeys = 1 << 24;
+   int numFinds = 1 << 22;
+
+   for (int i = 1; i < argc; i++)
+   {
+      if (strcmp(argv[i], "-keys") == 0 && i + 1 < argc)
+      {
+         maxKeys = atoi(argv[++i]);
+      }
+      else if (strcmp(argv[i], "-finds") == 0 && i + 1 < argc)
+      {
+         numFinds = atoi(argv[++i]);
+      }
+      else
+      {
+         cout << "Usage: benchfrozen [-keys n] [-finds n]\n";
+         return 0;
+      }
+   }
+
+   if (maxKeys < (1 << 16) || numFinds < 1)
+   {
+      cout << "Usage: benchfrozen [-keys n] [-finds n]\n";
+      cout << "at least 65536 keys\n";
+      return 0;
+   }
+
+   printf("%-10s %12s %12s %10s\n", "keys", "avl M/s", "frozen M/s", "speedup");
+   for (int numKeys = 1 << 16; numKeys <= maxKeys; numKeys *= 4)
+   {
+      vector<int> keys;
+      scrambledKeys(numKeys, keys);
+
+      bintree<Key> tree;
+      for (int i = 0; i < numKeys; i++)
+      {
+         tree.insert(Key(keys[i]));
+      }
+
+      srand(numKeys);
+      vector<Key> finds(numFinds);
+      for (int i = 0; i < numFinds; i++)
+      {
+         finds[i] = Key(rand() % numKeys);
+      }
+
+      long avlSum, frozenSum;
+      double avl = timeFinds(tree, finds, avlSum);
+      frozenTree<Key> frozen = tree.freeze();
+      double fast = timeFinds(frozen, finds, frozenSum);
+
+      if (avlSum != frozenSum)
+      {
+         cout << "Frozen tree finds differ for " << numKeys << " keys\n";
+         return 1;
+      }
+
+      printf("%-10d %12.2f %12.2f %9.2fx\n", numKeys,
+             numFinds / avl / 1e6, numFinds / fast / 1e6, avl / fast);
+   }
+   return 0;
+}
@@ -0,0 +1,119 @@
+#include <chrono>
+#include <iostream>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+#include "mazegrid.h"
+#include "gridbfs.h"
+#include "jumppoint.h"
+
+using namespace std;
+
+/*Times jump point search against breadth first search on
+open rooms, the maps jps is meant for.
+
+Usage: benchjps [-size n] [-runs n]
+
+Each room is n by n, 4000 by default, with a wall all
+round, the start in the top left and the finish in the
+bottom right. The rooms are empty, 3% walls and 10%
+walls, scattered at random with a fixed seed so every
+run sees the same rooms. Each time covers building the
+solver and one solve, the best of runs is printed.*/
+
+void buildRoom(MazeGrid &grid, int size, int wallPercent)
+{
+   srand(size + wallPercent);
+   grid.resize(size, size);
+
+   string line(size, ' ');
+   for (int y = 0; y < size; y++)
+   {
+      for (int x = 0; x < size; x++)
+      {
+         bool border = (x == 0 || y == 0 || x == size - 1 || y == size - 1);
+         line[x] = (border || rand() % 100 < wallPercent) ? '#' : ' ';
+      }
+      if (y == 1)
+      {
+         line[1] = 's';
+      }
+      if (y == size - 2)
+      {
+         line[size - 2] = 'f';
+      }
+      grid.setRow(y, line);
+   }
+}
+
+template <typename SolverType>
+double timeSolve(const MazeGrid &grid, int size, int runs, int &pathLength)
+{
+   double best = 0;
+   for (int r = 0; r < runs; r++)
+   {
+      chrono::steady_clock::time_point begin = chrono::steady_clock::now();
+
+      SolverType solver(grid);
+      vector<GridPoint> path;
+      solver.solve(1, 1, size - 2, size - 2, path);
+      pathLength = path.size();
+
+      chrono::duration<double> taken = chrono::steady_clock::now() - begin;
+      if (r == 0 || taken.count() < best)
+      {
+         best = taken.count();
+      }
+   }
+   return best;
+}
+
+int main(int argc, char *argv[])
+{
+   int size = 4000;
+   int runs = 3;
+
+   for (int i = 1; i < argc; i++)
+   {
+      if (strcmp(argv[i], "-size") == 0 && i + 1 < argc)
+      {
+         size = atoi(argv[++i]);
+      }
+      else if (strcmp(argv[i], "-runs") == 0 && i + 1 < argc)
+      {
+         runs = atoi(argv[++i]);
+      }
+      else
+      {
+         cout << "Usage: benchjps [-size n] [-runs n]\n";
+         return 0;
+      }
+   }
+
+   if (size < 4 || runs < 1)
+   {
+      cout << "Usage: benchjps [-size n] [-runs n]\n";
+      return 0;
+   }
+
+   static const int wallPercents[3] = { 0, 3, 10 };
+
+   printf("%-12s %10s %10s %10s %10s\n", "room", "bfs s", "jps s", "bfs path", "jps path");
+   for (int i = 0; i < 3; i++)
+   {
+      MazeGrid grid;
+      buildRoom(grid, size, wallPercents[i]);
+
+      int bfsLength, jpsLength;
+      double bfs = timeSolve< GridBfsSolver<MazeGrid> >(grid, size, runs, bfsLength);
+      double jps = timeSolve<JumpPointSolver>(grid, size, runs, jpsLength);
+
+      char room[32];
+      snprintf(room, sizeof(room), "%d%% walls", wallPercents[i]);
+      printf("%-12s %10.3f %10.3f %10d %10d\n", room, bfs, jps, bfsLength, jpsLength);
+   }
+   return 0;
+}
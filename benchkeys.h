@@ -0,0 +1,48 @@
+#ifndef BENCHKEYS_H
+#define BENCHKEYS_H
+
+#include <algorithm>
+#include <numeric>
+#include <random>
+#include <string>
+#include <vector>
+
+/********************************************************\
+   keys for the tree benchmarks
+
+   An int key with the comparisons bintree needs, and the
+   keys 0 to n - 1 in a scrambled order. Inserting them in
+   that order spreads the nodes over the heap the way a
+   real load does. The order comes from a fixed seed so
+   every run builds the same tree.
+\********************************************************/
+
+class Key
+{
+   private:
+      int value;
+
+   public:
+      Key(int v = 0) : value(v) {}
+
+      int getValue() const { return value; }
+
+      bool operator < (const Key &other) const { return value < other.value; }
+      bool operator == (const Key &other) const { return value == other.value; }
+      bool operator <= (const Key &other) const { return value <= other.value; }
+      bool operator >= (const Key &other) const { return value >= other.value; }
+
+      std::string toString() const { return std::to_string(value); }
+};
+
+inline void scrambledKeys(int numKeys, std::vector<int> &keys)
+{
+   // every key from 0 to numKeys - 1 once, for any numKeys
+   keys.resize(numKeys);
+   std::iota(keys.begin(), keys.end(), 0);
+
+   std::mt19937 random(12345);
+   std::shuffle(keys.begin(), keys.end(), random);
+}
+
+#endif
@@ -0,0 +1,142 @@
+#include <chrono>
+#include <iostream>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+#include "mazegrid.h"
+#include "gridbfs.h"
+
+using namespace std;
+
+/*Times the grid breadth first search on the row-major and
+the tiled grid layouts across maze widths.
+
+Usage: benchlayout [-cells n] [-runs n]
+
+Every maze has about n cells, 2^24 by default, and goes
+from 256 wide up to 65536 wide with the height cut to
+match. A quarter of the cells are walls, scattered at
+random with a seed set by the width so both layouts see
+the same maze. The start is the top left cell and the
+finish the bottom right, and a random walk right and
+down between them is kept clear so every maze has a
+path. Each time is one solve, the best of runs is
+printed along with the length of the path found.*/
+
+template <typename GridType>
+void buildMaze(GridType &grid, int width, int height)
+{
+   srand(width);
+   vector<string> rows(height, string(width, ' '));
+   for (int y = 0; y < height; y++)
+   {
+      for (int x = 0; x < width; x++)
+      {
+         if (rand() % 100 < 25) rows[y][x] = '#';
+      }
+   }
+
+   // a walk right and down from the start to the finish is
+   // cleared, so there is always a path whatever the walls
+   int x = 0, y = 0;
+   rows[0][0] = ' ';
+   while (x < width - 1 || y < height - 1)
+   {
+      bool right = (y == height - 1) || (x < width - 1 &&
+                   rand() % (width + height) < width);
+      if (right) x++;
+      else y++;
+      rows[y][x] = ' ';
+   }
+
+   rows[0][0] = 's';
+   rows[height - 1][width - 1] = 'f';
+
+   grid.resize(width, height);
+   for (int y = 0; y < height; y++)
+   {
+      grid.setRow(y, rows[y]);
+   }
+}
+
+template <typename GridType>
+double timeSolve(int width, int height, int runs, int &pathLength)
+{
+   GridType grid;
+   buildMaze(grid, width, height);
+
+   double best = 0;
+   for (int r = 0; r < runs; r++)
+   {
+      chrono::steady_clock::time_point begin = chrono::steady_clock::now();
+
+      GridBfsSolver<GridType> solver(grid);
+      vector<GridPoint> path;
+      solver.solve(0, 0, width - 1, height - 1, path);
+      pathLength = path.size();
+
+      chrono::duration<double> taken = chrono::steady_clock::now() - begin;
+      if (r == 0 || taken.count() < best)
+      {
+         best = taken.count();
+      }
+   }
+   return best;
+}
+
+int main(int argc, char *argv[])
+{
+   long cells = 1L << 24;
+   int runs = 3;
+
+   for (int i = 1; i < argc; i++)
+   {
+      if (strcmp(argv[i], "-cells") == 0 && i + 1 < argc)
+      {
+         cells = atol(argv[++i]);
+      }
+      else if (strcmp(argv[i], "-runs") == 0 && i + 1 < argc)
+      {
+         runs = atoi(argv[++i]);
+      }
+      else
+      {
+         cout << "Usage: benchlayout [-cells n] [-runs n]\n";
+         return 0;
+      }
+   }
+
+   if (cells < 65536 * 2 || runs < 1)
+   {
+      cout << "Usage: benchlayout [-cells n] [-runs n]\n";
+      cout << "at least 131072 cells\n";
+      return 0;
+   }
+
+   static const int widths[5] = { 256, 1024, 4096, 16384, 65536 };
+
+   printf("%-14s %12s %12s %10s\n", "maze", "row-major s", "tiled s", "path");
+   for (int i = 0; i < 5; i++)
+   {
+      int width = widths[i];
+      int height = cells / width;
+
+      int rowLength, tiledLength;
+      double rowMajor = timeSolve<MazeGrid>(width, height, runs, rowLength);
+      double tiled = timeSolve<TiledMazeGrid>(width, height, runs, tiledLength);
+
+      if (rowLength != tiledLength || rowLength == 0)
+      {
+         cout << "No path or the layouts disagree on it for width " << width << "\n";
+         return 1;
+      }
+
+      char maze[32];
+      snprintf(maze, sizeof(maze), "%dx%d", width, height);
+      printf("%-14s %12.3f %12.3f %10d\n", maze, rowMajor, tiled, rowLength);
+   }
+   return 0;
+}
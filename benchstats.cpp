@@ -0,0 +1,108 @@
+#include <chrono>
+#include <iostream>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+#include "benchkeys.h"
+#include "bintree.h"
+
+using namespace std;
+
+/*Times polling the tree statistics while a bintree is
+being filled, the way a metrics exporter would read them.
+
+Usage: benchstats [-keys n] [-every n]
+
+n keys, 2^21 by default, are inserted in a scrambled
+order and then half of them are erased. After every n
+changes, 1000 by default, balance(), maxTreeDepth() and
+numLeafNodes() are read. The polls are timed on their
+own, timing a second run without them would be skewed
+by the heap the first run left behind.*/
+
+struct PollTotals
+{
+   long polls;
+   double seconds;
+   double balance;
+   long depth, leaves;
+};
+
+void poll(const bintree<Key> &tree, PollTotals &totals)
+{
+   // the totals keep the reads from being optimised away
+   chrono::steady_clock::time_point begin = chrono::steady_clock::now();
+
+   totals.polls++;
+   totals.balance += tree.balance();
+   totals.depth += tree.maxTreeDepth();
+   totals.leaves += tree.numLeafNodes();
+
+   chrono::duration<double> taken = chrono::steady_clock::now() - begin;
+   totals.seconds += taken.count();
+}
+
+double fillAndEmpty(int numKeys, int every, PollTotals &totals)
+{
+   vector<int> keys;
+   scrambledKeys(numKeys, keys);
+
+   chrono::steady_clock::time_point begin = chrono::steady_clock::now();
+   bintree<Key> tree;
+   for (int i = 0; i < numKeys; i++)
+   {
+      tree.insert(Key(keys[i]));
+      if (i % every == 0) poll(tree, totals);
+   }
+   for (int i = 0; i < numKeys; i += 2)
+   {
+      tree.erase(Key(i));
+      if (i % every == 0) poll(tree, totals);
+   }
+
+   chrono::duration<double> taken = chrono::steady_clock::now() - begin;
+   return taken.count();
+}
+
+int main(int argc, char *argv[])
+{
+   int numKeys = 1 << 21;
+   int every = 1000;
+
+   for (int i = 1; i < argc; i++)
+   {
+      if (strcmp(argv[i], "-keys") == 0 && i + 1 < argc)
+      {
+         numKeys = atoi(argv[++i]);
+      }
+      else if (strcmp(argv[i], "-every") == 0 && i + 1 < argc)
+      {
+         every = atoi(argv[++i]);
+      }
+      else
+      {
+         cout << "Usage: benchstats [-keys n] [-every n]\n";
+         return 0;
+      }
+   }
+
+   if (numKeys < 2 || every < 1)
+   {
+      cout << "Usage: benchstats [-keys n] [-every n]\n";
+      return 0;
+   }
+
+   PollTotals totals = { 0, 0, 0, 0, 0 };
+   double total = fillAndEmpty(numKeys, every, totals);
+
+   printf("%d keys, polled every %d changes\n", numKeys, every);
+   printf("   %-18s %10.3f s\n", "inserts and erases", total - totals.seconds);
+   printf("   %-18s %10.3f s\n", "polling", totals.seconds);
+   printf("   %-18s %10ld\n", "polls", totals.polls);
+   printf("   %-18s %10.3f us\n", "per poll", totals.seconds / totals.polls * 1e6);
+   printf("   %-18s %10.3f\n", "mean balance", totals.balance / totals.polls);
+   return 0;
+}
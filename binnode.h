@@ -6,15 +6,67 @@
 #include <stdexcept>
 #include <assert.h>
 #include <string.h>
+#include <utility>
+#include <vector>
 
 #define NDEBUG
 
+/********************************************************\
+   stack used to walk a tree without recursion. The first
+   64 entries live in the stack object itself, which covers
+   any balanced tree, and only deeper paths touch the heap.
+\********************************************************/
+
+template <typename itemType> class pathStack
+{
+   private:
+      static const int fixedSize = 64;
+      
+      itemType fixed[fixedSize];
+      std::vector<itemType> overflow;
+      int count;
+      
+   public:
+      pathStack() : count(0) 
+      {
+      }
+      
+      bool empty() const 
+      {
+         return (count == 0);
+      }
+      
+      void push(const itemType &item)
+      {
+         if (count < fixedSize) fixed[count] = item;
+         else overflow.push_back(item);
+         count++;
+      }
+      
+      itemType pop()
+      {
+         count--;
+         if (count < fixedSize) return fixed[count];
+         
+         itemType item = overflow.back();
+         overflow.pop_back();
+         return item;
+      }
+};
+
 /********************************************************\
    template node class for binary tree
 \********************************************************/
 
+template <typename dataType> class bintree;
+template <typename dataType, typename valueType> class bintreeIterator;
+
 template <typename dataType> class binNode 
 {
+   // the tree and its iterators walk the child pointers directly
+   friend class bintree<dataType>;
+   template <typename, typename> friend class bintreeIterator;
+
    private:
       // private data ====================================
       dataType nodeData;
@@ -23,25 +75,71 @@ template <typename dataType> class binNode
       // maximum height of this node and it's subtrees
       int height;
       
+      // number of nodes and of leaf nodes in this subtree, kept
+      // up to date along with height so the tree statistics
+      // can be read without walking the tree
+      int nodeCount, leafCount;
+      
       // private functions ===============================
       
+      static void rebalancePath(pathStack<binNode<dataType>**> &path)
+      {
+         // rebalance each node on a path from the bottom up, the
+         // stack holds the links that point at each node
+         while (!path.empty())
+         {
+            binNode<dataType>* &link = *path.pop();
+            link->rebalance(link);
+         }
+      }
+      
       void addTreeToLeft(binNode<dataType>* &root, binNode<dataType> *tree)
       {
           assert(tree != NULL);
           assert(root == this);
-            
-          if (left == NULL)
-          {
-             left = tree;
-          }
-          else 
+          
+          // hang tree off the left most node then rebalance
+          // back up to root
+          pathStack<binNode<dataType>**> path;
+          binNode<dataType>* *link = &root;
+          
+          path.push(link);
+          while ((*link)->left != NULL)
           {
-             left->addTreeToLeft(left, tree); 
+             link = &((*link)->left);
+             path.push(link);
           }
+          (*link)->left = tree;
           
-          rebalance(root);
+          rebalancePath(path);
       }
             
+      template <typename itemType>
+      void insertItem(binNode<dataType>* &root, itemType&& dataItem) 
+      {
+         // walk down to the empty link where the item belongs
+         // remembering the way so the nodes above it can be
+         // rebalanced on the way back up
+         pathStack<binNode<dataType>**> path;
+         binNode<dataType>* *link = &root;
+         
+         while (*link != NULL)
+         {
+            binNode<dataType> *node = *link;
+            if (node->nodeData == dataItem) 
+            {
+               throw std::invalid_argument("dataItem already in tree");
+            }
+            
+            path.push(link);
+            if (dataItem < node->nodeData) link = &(node->left);
+            else link = &(node->right);
+         }
+         
+         *link = new binNode(std::forward<itemType>(dataItem));
+         rebalancePath(path);
+      }
+
       void deleteNode(binNode<dataType>* &root) 
       {
          assert(root == this);
@@ -79,7 +177,13 @@ template <typename dataType> class binNode
       
       void updateHeight()
       {
+         // the children are always up to date first so this node's
+         // statistics come straight from theirs
          height = 1 + maxSubtreeHeight();
+         nodeCount = 1 + leftNodeCount() + rightNodeCount();
+         
+         if (left == NULL && right == NULL) leafCount = 1;
+         else leafCount = leftLeafCount() + rightLeafCount();
       }
       
       // rotations ===============================================
@@ -166,12 +270,20 @@ template <typename dataType> class binNode
       \********************************************************/
 
       // constructors
-      binNode() : left(NULL), right(NULL), height(1) 
+      binNode() : left(NULL), right(NULL), height(1), 
+         nodeCount(1), leafCount(1) 
       {
       }
    
       binNode(const dataType& dataItem) :
-         nodeData(dataItem), left(NULL), right(NULL), height(1) 
+         nodeData(dataItem), left(NULL), right(NULL), height(1), 
+         nodeCount(1), leafCount(1) 
+      {
+      }
+
+      binNode(dataType&& dataItem) :
+         nodeData(std::move(dataItem)), left(NULL), right(NULL), height(1), 
+         nodeCount(1), leafCount(1) 
       {
       }
 
@@ -195,6 +307,21 @@ template <typename dataType> class binNode
              right = NULL;
           }
           height = other.height;
+          nodeCount = other.nodeCount;
+          leafCount = other.leafCount;
+      }
+
+      // move constructor, takes over the subtrees of other
+      binNode(binNode<dataType> &&other) noexcept :
+         nodeData(std::move(other.nodeData)), left(other.left), 
+         right(other.right), height(other.height), 
+         nodeCount(other.nodeCount), leafCount(other.leafCount)
+      {
+         other.left = NULL;
+         other.right = NULL;
+         other.height = 1;
+         other.nodeCount = 1;
+         other.leafCount = 1;
       }
    
       // destructor
@@ -204,109 +331,95 @@ template <typename dataType> class binNode
          if (right != NULL) delete right;
       }
    
+      /********************************************************\
+         bulk build
+      \********************************************************/
+
+      template <typename iterType>
+      static binNode<dataType>* buildBalanced(iterType first, int count)
+      {
+         /*Build a perfectly balanced subtree from count sorted
+         items starting at first. The middle item is the root
+         and each half is built the same way, so every item is
+         placed once and no rotations are needed.*/
+         if (count == 0) return NULL;
+
+         int middle = count / 2;
+         binNode<dataType> *node = new binNode<dataType>(*(first + middle));
+         node->left = buildBalanced(first, middle);
+         node->right = buildBalanced(first + middle + 1, count - middle - 1);
+         node->updateHeight();
+         return node;
+      }
+
       /********************************************************\
          insert, delete and find
       \********************************************************/
 
       void insert(binNode<dataType>* &root, const dataType& dataItem) 
       {
-         if (nodeData == dataItem) 
-         {
-            throw std::invalid_argument("dataItem already in tree");
-         }
-      
-         if (dataItem < nodeData) 
-         {
-            if (left == NULL) 
-            {
-               left = new binNode(dataItem);
-            } 
-            else 
-            {
-               left->insert(left, dataItem);
-            }
-         } 
-         else 
-         {
-            if (right == NULL) 
-            {
-               right = new binNode(dataItem);
-            } 
-            else 
-            {
-               right->insert(right, dataItem);
-            }
-         }
-         rebalance(root);
+         insertItem(root, dataItem);
+      }
+
+      void insert(binNode<dataType>* &root, dataType&& dataItem) 
+      {
+         // the item is only moved once its place is found
+         insertItem(root, std::move(dataItem));
       }
       
       void erase(binNode<dataType>* &root, const dataType &delData) 
       {
-         if (delData == nodeData) 
-         {
-            deleteNode(root);
-         } 
-         else 
+         pathStack<binNode<dataType>**> path;
+         binNode<dataType>* *link = &root;
+         
+         while (!(delData == (*link)->nodeData))
          {
-            if (delData < nodeData) 
-            {
-               if (left == NULL) 
-               {
-                  throw std::invalid_argument("delItem not in tree");
-               } 
-               else 
-               {
-                  left->erase(left, delData);
-               }
-            } 
-            else 
+            binNode<dataType> *node = *link;
+            path.push(link);
+            
+            if (delData < node->nodeData) link = &(node->left);
+            else link = &(node->right);
+            
+            if (*link == NULL) 
             {
-               if (right == NULL) 
-               {
-                  throw std::invalid_argument("delItem not in tree");
-               } 
-               else 
-               {
-                  right->erase(right, delData);
-               }
+               throw std::invalid_argument("delItem not in tree");
             }
-            rebalance(root);
          }
+         
+         (*link)->deleteNode(*link);
+         rebalancePath(path);
       }
       
-      dataType* find(const dataType &findData)
+      template <typename keyType>
+      dataType* find(const keyType &findData)
       {
-         if (findData == nodeData) 
-         {
-            return &nodeData;
-         } 
-         else if (findData < nodeData) 
-         {
-            if (left == NULL) return NULL;
-            else return left->find(findData);
-         } 
-         else 
-         {
-            if (right == NULL) return NULL;
-            else return right->find(findData);
-         }
+         // the same walk as findConst, the node is this one's own
+         return const_cast<dataType*>(findConst(findData));
       }
 	  
-	  const dataType* findConst(const dataType &findData) const
+      template <typename keyType>
+      const dataType* findConst(const keyType &findData) const
       {
-         if (findData == nodeData) 
-         {
-            return &nodeData;
-         } 
-         else if (findData < nodeData) 
-         {
-            if (left == NULL) return NULL;
-            else return left->findConst(findData);
-         } 
-         else 
+         // findData can be any key that compares with dataType
+         // through key < data and key == data.
+         // the null checks stay on each side so the compiler keeps
+         // real branches, a conditional move here would stop the
+         // cpu running ahead down the tree
+         const binNode<dataType> *node = this;
+         while (true)
          {
-            if (right == NULL) return NULL;
-            else return right->findConst(findData);
+            if (findData == node->nodeData) return &(node->nodeData);
+            
+            if (findData < node->nodeData) 
+            {
+               if (node->left == NULL) return NULL;
+               node = node->left;
+            }
+            else 
+            {
+               if (node->right == NULL) return NULL;
+               node = node->right;
+            }
          }
       }
       
@@ -339,36 +452,24 @@ template <typename dataType> class binNode
          tree information
       \********************************************************/
 
-      // tree statistic functions
+      // tree statistic functions, all read from the counts
+      // kept in each node so they are O(1)
 	  
       int numLeafNodes() const 
       {
-         if (height == 1) return 1;
-         
-         int numLeaf = 0;
-         if (left != NULL) numLeaf += left->numLeafNodes();
-         if (right != NULL) numLeaf += right->numLeafNodes();
-         return numLeaf;
+         return leafCount;
       }
 
-
       int maxTreeDepth() const 
       {
-         int rdepth = 0, ldepth = 0;
-         
-         if (left != NULL) ldepth = left->maxTreeDepth();
-         if (right != NULL) rdepth = right->maxTreeDepth();
-         
-         if (ldepth > rdepth) return 1 + ldepth;
-         else return 1 + rdepth;
+         // every path down ends in a leaf at height 1, so the
+         // deepest one is as long as this node is high
+         return height;
       }
 
       int numNodes() const 
       {  
-         int numNode = 1;
-         if (left != NULL) numNode += left->numNodes();
-         if (right != NULL) numNode += right->numNodes();
-         return numNode;
+         return nodeCount;
       }
       
       void print() const 
@@ -399,6 +500,30 @@ template <typename dataType> class binNode
          else return right->getHeight();
       }
       
+      int leftNodeCount() const 
+      {
+         if (left == NULL) return 0;
+         else return left->nodeCount;
+      }
+      
+      int rightNodeCount() const 
+      {
+         if (right == NULL) return 0;
+         else return right->nodeCount;
+      }
+      
+      int leftLeafCount() const 
+      {
+         if (left == NULL) return 0;
+         else return left->leafCount;
+      }
+      
+      int rightLeafCount() const 
+      {
+         if (right == NULL) return 0;
+         else return right->leafCount;
+      }
+      
       int maxSubtreeHeight() const
       {
          if (leftTreeHeight() >= rightTreeHeight())
@@ -438,39 +563,76 @@ template <typename dataType> class binNode
          
       bool verifyTree(char *error) const
       {
-          // check subtree height is correct in relation to subtree
-          int max = leftTreeHeight();
-          if (rightTreeHeight() > max) max = rightTreeHeight();
-          
-          if (height != max + 1)
+          // checks each node in the same order as a recursive
+          // walk would, an entry is a node with the parent it
+          // hangs off and which side it is on
+          struct checkItem
           {
-             strcpy(error, "Invalid height in tree");
-             return false;
-          }
+             const binNode<dataType> *node, *parent;
+             bool isLeft;
+          };
+          
+          pathStack<checkItem> todo;
+          checkItem first = { this, NULL, false };
+          todo.push(first);
           
-          // check left subtree
-          if (left != NULL)
+          while (!todo.empty())
           {
-             if (left->nodeData >= nodeData)
+             checkItem item = todo.pop();
+             const binNode<dataType> *node = item.node;
+             
+             // check the node is on the right side of its parent
+             if (item.parent != NULL && item.isLeft && 
+                   node->nodeData >= item.parent->nodeData)
              {
                 strcpy(error, "Left node out of order");
                 return false;
              }
-             if (!left->verifyTree(error)) return false;
-          }
-          
-          // check right subtree
-          if (right != NULL)
-          {
-             if (right->nodeData <= nodeData)
+             if (item.parent != NULL && !item.isLeft && 
+                   node->nodeData <= item.parent->nodeData)
              {
                 strcpy(error, "Right node out of order");
                 return false;
              }
-             if (!right->verifyTree(error)) return false;
+             
+             // check subtree height is correct in relation to subtree
+             int max = node->leftTreeHeight();
+             if (node->rightTreeHeight() > max) max = node->rightTreeHeight();
+             
+             if (node->height != max + 1)
+             {
+                strcpy(error, "Invalid height in tree");
+                return false;
+             }
+             
+             // check the cached counts agree with the subtrees
+             if (node->nodeCount != 1 + node->leftNodeCount() + node->rightNodeCount())
+             {
+                strcpy(error, "Invalid node count in tree");
+                return false;
+             }
+             
+             int leaves = node->leftLeafCount() + node->rightLeafCount();
+             if (node->leafCount != (leaves == 0 ? 1 : leaves))
+             {
+                strcpy(error, "Invalid leaf count in tree");
+                return false;
+             }
+             
+             // left is pushed last so it is checked first
+             if (node->right != NULL) 
+             {
+                checkItem right = { node->right, node, false };
+                todo.push(right);
+             }
+             if (node->left != NULL) 
+             {
+                checkItem left = { node->left, node, true };
+                todo.push(left);
+             }
           }
              
-          // no falses created so this node and its subtrees are ok
+          // no falses created so every node is ok
           return true;
       }
       
@@ -487,6 +649,8 @@ template <typename dataType> class binNode
 
       binNode<dataType>& operator = (const binNode<dataType> &other) 
       {
+         if (this == &other) return *this;
+
          // remove current subtrees
          if (left != NULL) delete left;
          if (right != NULL) delete right;
@@ -511,6 +675,34 @@ template <typename dataType> class binNode
 
          // make nodedata equal nodedata of other
          nodeData = other.nodeData;
+         height = other.height;
+         nodeCount = other.nodeCount;
+         leafCount = other.leafCount;
+         return *this;
+      }
+
+      binNode<dataType>& operator = (binNode<dataType> &&other) noexcept
+      {
+         if (this != &other)
+         {
+            // remove current subtrees and take over those of other
+            if (left != NULL) delete left;
+            if (right != NULL) delete right;
+
+            nodeData = std::move(other.nodeData);
+            left = other.left;
+            right = other.right;
+            height = other.height;
+            nodeCount = other.nodeCount;
+            leafCount = other.leafCount;
+
+            other.left = NULL;
+            other.right = NULL;
+            other.height = 1;
+            other.nodeCount = 1;
+            other.leafCount = 1;
+         }
+         return *this;
       }
 };
 
@@ -3,8 +3,171 @@
 
 #include <stdexcept>
 #include <math.h>
+#include <cstddef>
+#include <iterator>
+#include <utility>
+#include <vector>
 
 #include "binnode.h"
+#include "frozentree.h"
+
+/********************************************************\
+   in-order iterator for a binary tree
+
+   Holds the path of nodes from the root down to the
+   current node, so stepping either way is amortised O(1)
+   and a whole tree is walked in O(n). An empty path is
+   the end of the tree. valueType is dataType or const
+   dataType, the data must not be changed in a way that
+   alters its place in the tree.
+\********************************************************/
+
+template <typename dataType, typename valueType> class bintreeIterator
+{
+   private:
+      // private data ====================================
+      binNode<dataType> *root;
+      std::vector<binNode<dataType>*> path;
+
+      // private functions ===============================
+
+      void pushLeftEdge(binNode<dataType> *node)
+      {
+         while (node != NULL)
+         {
+            path.push_back(node);
+            node = node->left;
+         }
+      }
+
+      void pushRightEdge(binNode<dataType> *node)
+      {
+         while (node != NULL)
+         {
+            path.push_back(node);
+            node = node->right;
+         }
+      }
+
+      template <typename, typename> friend class bintreeIterator;
+      template <typename> friend class bintree;
+
+   public:
+      typedef std::bidirectional_iterator_tag iterator_category;
+      typedef dataType value_type;
+      typedef std::ptrdiff_t difference_type;
+      typedef valueType* pointer;
+      typedef valueType& reference;
+
+      /*******************************************************\
+         constructors
+      \*******************************************************/
+
+      bintreeIterator() : root(NULL) 
+      {
+      }
+
+      bintreeIterator(binNode<dataType> *treeRoot, bool atBegin) : root(treeRoot)
+      {
+         if (atBegin) pushLeftEdge(root);
+      }
+
+      // a mutable iterator can be used where a const one is wanted
+      template <typename otherType>
+      bintreeIterator(const bintreeIterator<dataType, otherType> &other) :
+         root(other.root), path(other.path)
+      {
+      }
+
+      /*******************************************************\
+         overloaded operators
+      \*******************************************************/
+
+      reference operator * () const
+      {
+         return path.back()->nodeData;
+      }
+
+      pointer operator -> () const
+      {
+         return &(path.back()->nodeData);
+      }
+
+      bintreeIterator& operator ++ ()
+      {
+         // next item is the left most node of the right subtree, or
+         // the first ancestor we reach by coming up from its left
+         binNode<dataType> *node = path.back();
+         if (node->right != NULL)
+         {
+            pushLeftEdge(node->right);
+            return *this;
+         }
+
+         binNode<dataType> *child;
+         do
+         {
+            child = path.back();
+            path.pop_back();
+         } while (!path.empty() && path.back()->left != child);
+         return *this;
+      }
+
+      bintreeIterator& operator -- ()
+      {
+         // stepping back from the end goes to the right most item
+         if (path.empty())
+         {
+            pushRightEdge(root);
+            return *this;
+         }
+
+         binNode<dataType> *node = path.back();
+         if (node->left != NULL)
+         {
+            pushRightEdge(node->left);
+            return *this;
+         }
+
+         binNode<dataType> *child;
+         do
+         {
+            child = path.back();
+            path.pop_back();
+         } while (!path.empty() && path.back()->right != child);
+         return *this;
+      }
+
+      bintreeIterator operator ++ (int)
+      {
+         bintreeIterator old(*this);
+         ++(*this);
+         return old;
+      }
+
+      bintreeIterator operator -- (int)
+      {
+         bintreeIterator old(*this);
+         --(*this);
+         return old;
+      }
+
+      template <typename otherType>
+      bool operator == (const bintreeIterator<dataType, otherType> &other) const
+      {
+         if (path.empty() || other.path.empty())
+         {
+            return path.empty() && other.path.empty();
+         }
+         return path.back() == other.path.back();
+      }
+
+      template <typename otherType>
+      bool operator != (const bintreeIterator<dataType, otherType> &other) const
+      {
+         return !(*this == other);
+      }
+};
 
 /********************************************************\
    template class for a binary tree
@@ -52,6 +215,14 @@ template <typename dataType> class bintree
          }
       }
       
+      // move constructor, takes over the nodes of other
+      bintree(bintree<dataType> &&other) noexcept : 
+         root(other.root), numItems(other.numItems)
+      {
+         other.root = NULL;
+         other.numItems = 0;
+      }
+      
       // destructor
       ~bintree() 
       {
@@ -74,6 +245,12 @@ template <typename dataType> class bintree
          return numItems;
       }
       
+      size_t memoryUsed() const
+      {
+         // bytes held by the nodes, each one is allocated on its own
+         return (size_t)numItems * sizeof(binNode<dataType>);
+      }
+
       int treeHeight() const 
       {
          // return the maximum height of the tree
@@ -117,6 +294,8 @@ template <typename dataType> class bintree
       double balance() const 
       {
          // Returns a measure of how balanced a tree is.
+         // The depth and leaf count are kept in the nodes so
+         // this is O(1) and cheap enough to poll often.
          // A value of 1 is a prefectly balanced tree.
          // The closer to 0 the value is the more unbalanced
          // the tree.
@@ -164,6 +343,50 @@ template <typename dataType> class bintree
          }
          numItems++;
       }
+
+      void insert(dataType&& newData) 
+      {
+         // insert the newData into the tree, moving it into its node
+         
+         if (root == NULL) 
+         {
+            root = new binNode<dataType>(std::move(newData));
+         } 
+         else 
+         {
+            root->insert(root, std::move(newData));
+         }
+         numItems++;
+      }
+      
+      template <typename... argTypes>
+      void emplace(argTypes&&... args)
+      {
+         // build the item from args and move it into the tree
+         
+         insert(dataType(std::forward<argTypes>(args)...));
+      }
+      
+      template <typename iterType>
+      void buildFromSorted(iterType first, iterType last)
+      {
+         // replace the contents of the tree with the items in
+         // [first, last), which must be sorted and unique.
+         // Builds a balanced tree in O(n) without any rotations
+         
+         int count = last - first;
+         for (int i = 1; i < count; i++)
+         {
+            if (!(*(first + i - 1) < *(first + i)))
+            {
+               throw std::invalid_argument("items not sorted and unique");
+            }
+         }
+         
+         if (root != NULL) delete root;
+         root = binNode<dataType>::buildBalanced(first, count);
+         numItems = count;
+      }
       
       void erase(const dataType& delData) 
       {
@@ -179,22 +402,109 @@ template <typename dataType> class bintree
          numItems--;
       }
       
-      dataType* find(const dataType &findData)
+      template <typename keyType>
+      dataType* find(const keyType &findData)
       {
          // this function looks for findData in the tree.
 	     // If it finds the data it will return the address of the data 
 	     // in the tree. otherwise it will return NULL
+	     // findData may be a dataType or any key with key < data
+	     // and key == data defined, so no dataType has to be built
 	     
          if (root == NULL) return NULL;
          else return root->find(findData);
       }
 	  
-	  const dataType* findConst(const dataType& findData) const
+	  template <typename keyType>
+	  const dataType* findConst(const keyType& findData) const
 	  {
          if (root == NULL) return NULL;
          else return root->findConst(findData);
 	  }
 
+      frozenTree<dataType> freeze()
+      {
+         // move the items into a read only array layout for fast
+         // lookups once the tree won't change shape again.
+         // This tree is left empty
+         
+         frozenTree<dataType> frozen(std::make_move_iterator(begin()), numItems);
+         if (root != NULL) 
+         {
+            delete root;
+            root = NULL;
+         }
+         numItems = 0;
+         return frozen;
+      }
+      
+      /*******************************************************\
+         iterators
+      \*******************************************************/
+      
+      typedef bintreeIterator<dataType, dataType> iterator;
+      typedef bintreeIterator<dataType, const dataType> const_iterator;
+      
+      iterator begin()
+      {
+         return iterator(root, true);
+      }
+      
+      iterator end()
+      {
+         return iterator(root, false);
+      }
+      
+      const_iterator begin() const
+      {
+         return const_iterator(root, true);
+      }
+      
+      const_iterator end() const
+      {
+         return const_iterator(root, false);
+      }
+      
+      template <typename keyType>
+      iterator lower_bound(const keyType &findData)
+      {
+         // first item that is not less than findData, which can be
+         // any key that find accepts
+         
+         iterator it(root, false);
+         size_t found = 0;
+         
+         binNode<dataType> *node = root;
+         while (node != NULL)
+         {
+            it.path.push_back(node);
+            if (findData == node->nodeData)
+            {
+               found = it.path.size();
+               break;
+            }
+            else if (findData < node->nodeData)
+            {
+               found = it.path.size();
+               node = node->left;
+            }
+            else
+            {
+               node = node->right;
+            }
+         }
+         
+         // keep the path down to the last node we went left at
+         it.path.resize(found);
+         return it;
+      }
+      
+      template <typename keyType>
+      const_iterator lower_bound(const keyType &findData) const
+      {
+         return const_cast<bintree<dataType>*>(this)->lower_bound(findData);
+      }
+
       /*******************************************************\
          overloaded operators 
       \*******************************************************/
@@ -204,9 +514,12 @@ template <typename dataType> class bintree
 	     // make this tree equal to other. 
 		 // erases the entire current contents of the tree doing this
 		 
+         if (this == &other) return *this;
+         
          if (root != NULL) 
          {
             delete root;
+            root = NULL;
             numItems = 0;
          }
          if (other.root != NULL) 
@@ -217,6 +530,21 @@ template <typename dataType> class bintree
          return *this;
       }
 
+      bintree<dataType>& operator = (bintree<dataType> &&other) noexcept
+      {
+         // take over the nodes of other, leaving it empty
+         
+         if (this != &other)
+         {
+            if (root != NULL) delete root;
+            root = other.root;
+            numItems = other.numItems;
+            other.root = NULL;
+            other.numItems = 0;
+         }
+         return *this;
+      }
+
 
       /*******************************************************\
          print function for assignment. 
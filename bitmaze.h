@@ -0,0 +1,365 @@
+#ifndef BITMAZE_H
+#define BITMAZE_H
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "mazeerror.h"
+#include "mazegrid.h"
+#include "memstats.h"
+#include "rowscan.h"
+
+/********************************************************\
+   bit plane maze for very large mazes
+
+   Every cell is 4 bits spread over four planes:
+      open      - the cell can be walked on
+      visited   - reached by the search, reused to hold
+                  the path once the search is done
+      levelLow  - breadth first level of the cell mod 3,
+      levelHigh   coded 0 = 00, 1 = 01, 2 = 10
+   The level mod 3 is enough to walk back from the finish,
+   neighbours of a cell are always one level either side
+   of it so the three codes can't be confused.
+   The search expands a whole 64 bit word of the frontier
+   at once with shifts and masks.
+\********************************************************/
+
+class BitMaze
+{
+   private:
+      // private data ====================================
+      int width, height, words;
+      std::vector<int> rowLengths;
+
+      // first and last wall of each row, -1 if there are none
+      std::vector<int> firstWalls, lastWalls;
+
+      std::vector<uint64_t> openBits, visitedBits, levelLow, levelHigh;
+
+      int startX, startY, finishX, finishY;
+      int numStart, numFinish;
+
+      // set once markPath has turned the visited plane into the path
+      bool pathMarked;
+
+      // bytes of the row spans the last solve used
+      size_t spanBytes;
+
+      // words of one row holding the cells reached on the last level
+      struct RowSpan
+      {
+         int y, lo, hi;
+
+         RowSpan(int row, int loWord, int hiWord) : y(row), lo(loWord), hi(hiWord) {}
+      };
+
+      // private functions ===============================
+
+      size_t wordIndex(int y, int w) const
+      {
+         return (size_t)y * words + w;
+      }
+
+      bool testBit(const std::vector<uint64_t> &plane, int x, int y) const
+      {
+         if (x < 0 || y < 0 || x >= width || y >= height) return false;
+         return (plane[wordIndex(y, x >> 6)] >> (x & 63)) & 1;
+      }
+
+      void setBit(std::vector<uint64_t> &plane, int x, int y)
+      {
+         plane[wordIndex(y, x >> 6)] |= 1ULL << (x & 63);
+      }
+
+      int levelCode(int x, int y) const
+      {
+         return testBit(levelLow, x, y) + 2 * testBit(levelHigh, x, y);
+      }
+
+      uint64_t frontierWord(int y, int w, int code) const
+      {
+         // visited cells of word w in row y whose level code is code
+         if (y < 0 || y >= height || w < 0 || w >= words) return 0;
+
+         size_t i = wordIndex(y, w);
+         uint64_t match;
+         if (code == 0) match = ~(levelLow[i] | levelHigh[i]);
+         else if (code == 1) match = levelLow[i] & ~levelHigh[i];
+         else match = levelHigh[i] & ~levelLow[i];
+
+         return visitedBits[i] & match;
+      }
+
+      void reach(int y, int w, uint64_t bits, int code, std::vector<RowSpan> &next)
+      {
+         // mark the open, unvisited cells in bits as reached with the
+         // given level code and note the word for the next level
+         if (y < 0 || y >= height || bits == 0) return;
+
+         size_t i = wordIndex(y, w);
+         uint64_t fresh = bits & openBits[i] & ~visitedBits[i];
+         if (fresh == 0) return;
+
+         visitedBits[i] |= fresh;
+         if (code == 1) levelLow[i] |= fresh;
+         if (code == 2) levelHigh[i] |= fresh;
+
+         if (!next.empty() && next.back().y == y &&
+               w >= next.back().lo - 1 && w <= next.back().hi + 1)
+         {
+            if (w < next.back().lo) next.back().lo = w;
+            if (w > next.back().hi) next.back().hi = w;
+         }
+         else
+         {
+            next.push_back(RowSpan(y, w, w));
+         }
+      }
+
+      static bool validChar(char c)
+      {
+         return (c == '#' || c == ' ' || c == 's' || c == 'f' || c == '\n');
+      }
+
+      static void unableToLoad(const char *filename, const std::string &reason = "")
+      {
+         throw MazeError(reason + "Unable to load maze " + filename + "\n");
+      }
+
+      bool ifOutside(int x, int y) const
+      {
+         // same rule as Maze::ifOutside, the cell is outside when
+         // it is not between the first and last walls of its row
+         return (firstWalls[y] < 0 || x < firstWalls[y] || x > lastWalls[y]);
+      }
+
+   public:
+
+      /********************************************************\
+         constructor
+      \********************************************************/
+
+      BitMaze() : width(0), height(0), words(0),
+         startX(0), startY(0), finishX(0), finishY(0),
+         numStart(0), numFinish(0), pathMarked(false), spanBytes(0)
+      {
+      }
+
+      /********************************************************\
+         load and check
+      \********************************************************/
+
+      void loadMaze(const char *filename)
+      {
+         /*Read the file twice, once to size the planes and check
+         the characters and once to fill the open plane. The maze
+         is never held as text so only the planes take memory.*/
+         std::string line;
+         std::ifstream fin(filename);
+         if (!fin) unableToLoad(filename);
+
+         while (getline(fin, line))
+         {
+            for (unsigned int i = 0; i < line.length(); i++)
+            {
+               if (!validChar(line[i]))
+               {
+                  throw MazeError::invalidCharacter(firstWalls.size());
+               }
+            }
+            int firstWall, lastWall;
+            findWalls(line.data(), line.length(), firstWall, lastWall);
+            firstWalls.push_back(firstWall);
+            lastWalls.push_back(lastWall);
+
+            rowLengths.push_back(line.length());
+            if ((int)line.length() > width) width = line.length();
+         }
+
+         height = rowLengths.size();
+         words = (width + 63) >> 6;
+         openBits.assign((size_t)height * words, 0);
+
+         fin.clear();
+         fin.seekg(0);
+         for (int y = 0; y < height && getline(fin, line); y++)
+         {
+            for (unsigned int x = 0; x < line.length(); x++)
+            {
+               if (line[x] == '#') continue;
+
+               setBit(openBits, x, y);
+               if (line[x] == 's')
+               {
+                  numStart++;
+                  startX = x;
+                  startY = y;
+               }
+               if (line[x] == 'f')
+               {
+                  numFinish++;
+                  finishX = x;
+                  finishY = y;
+               }
+            }
+         }
+      }
+
+      void checkMaze(const char *mazeFile)
+      {
+         // same checks and messages as Maze::checkMaze
+         if (numStart > 0 && ifOutside(startX, startY))
+         {
+            unableToLoad(mazeFile, "Error - start declared outside of maze\n");
+         }
+         if (numFinish > 0 && ifOutside(finishX, finishY))
+         {
+            unableToLoad(mazeFile, "Error - finish declared outside of maze\n");
+         }
+         if (numStart != 1)
+         {
+            throw MazeError(std::string("Error - ") + (numStart == 0 ? "no" : "multiple") +
+                            " start found in maze\n");
+         }
+         if (numFinish != 1)
+         {
+            throw MazeError(std::string("Error - ") + (numFinish == 0 ? "no" : "multiple") +
+                            " finish found in maze\n");
+         }
+      }
+
+      /********************************************************\
+         solve
+      \********************************************************/
+
+      bool solve(std::vector<GridPoint> &path)
+      {
+         /*Level by level breadth first search. Only the words
+         holding cells reached on the last level are looked at,
+         each one pushes all of its cells into their neighbours
+         in one go. Returns false if the finish can't be reached.*/
+         visitedBits.assign(openBits.size(), 0);
+         levelLow.assign(openBits.size(), 0);
+         levelHigh.assign(openBits.size(), 0);
+         path.clear();
+
+         setBit(visitedBits, startX, startY);
+
+         std::vector<RowSpan> active, next;
+         active.push_back(RowSpan(startY, startX >> 6, startX >> 6));
+
+         int level = 0;
+         while (!active.empty() && !testBit(visitedBits, finishX, finishY))
+         {
+            int code = level % 3;
+            int nextCode = (level + 1) % 3;
+            next.clear();
+
+            for (unsigned int a = 0; a < active.size(); a++)
+            {
+               int y = active[a].y;
+               for (int w = active[a].lo; w <= active[a].hi; w++)
+               {
+                  uint64_t f = frontierWord(y, w, code);
+                  if (f == 0) continue;
+
+                  // push the word sideways, carrying the end bits into
+                  // the next words, and straight up and down
+                  reach(y, w, f | (f << 1) | (f >> 1), nextCode, next);
+                  if (w > 0) reach(y, w - 1, f << 63, nextCode, next);
+                  if (w + 1 < words) reach(y, w + 1, f >> 63, nextCode, next);
+                  reach(y - 1, w, f, nextCode, next);
+                  reach(y + 1, w, f, nextCode, next);
+               }
+            }
+
+            active.swap(next);
+            level++;
+         }
+         spanBytes = (active.capacity() + next.capacity()) * sizeof(RowSpan);
+
+         if (!testBit(visitedBits, finishX, finishY)) return false;
+
+         // walk back down the levels, trying down, up, right, left
+         static const int dirX[4] = { 0, 0, 1, -1 };
+         static const int dirY[4] = { 1, -1, 0, 0 };
+
+         GridPoint p(finishX, finishY);
+         path.push_back(p);
+         for (; level > 0; level--)
+         {
+            int want = (level - 1) % 3;
+            for (int d = 0; d < 4; d++)
+            {
+               int nx = p.x + dirX[d];
+               int ny = p.y + dirY[d];
+               if (testBit(visitedBits, nx, ny) && levelCode(nx, ny) == want)
+               {
+                  p = GridPoint(nx, ny);
+                  break;
+               }
+            }
+            path.push_back(p);
+         }
+
+         std::reverse(path.begin(), path.end());
+         return true;
+      }
+
+      /********************************************************\
+         path marking and output
+      \********************************************************/
+
+      void markPath(const std::vector<GridPoint> &path)
+      {
+         // the search is done with the visited plane, it now
+         // holds the cells to print as '.'
+         visitedBits.assign(openBits.size(), 0);
+         for (unsigned int i = 0; i < path.size(); i++)
+         {
+            setBit(visitedBits, path[i].x, path[i].y);
+         }
+         pathMarked = true;
+      }
+
+      void printMaze() const
+      {
+         std::string line;
+         for (int y = 0; y < height; y++)
+         {
+            line.assign(rowLengths[y], ' ');
+            for (int x = 0; x < rowLengths[y]; x++)
+            {
+               if (!testBit(openBits, x, y)) line[x] = '#';
+               else if (x == startX && y == startY) line[x] = 's';
+               else if (x == finishX && y == finishY) line[x] = 'f';
+               else if (pathMarked && testBit(visitedBits, x, y)) line[x] = '.';
+            }
+            std::cout << line << "\n";
+         }
+      }
+
+      void reportMemory(MemoryReport &report) const
+      {
+         size_t numCells = 0;
+         for (int y = 0; y < height; y++)
+         {
+            numCells += rowLengths[y];
+         }
+
+         report.setCells(numCells);
+         report.add("bit planes", (openBits.capacity() + visitedBits.capacity() +
+                    levelLow.capacity() + levelHigh.capacity()) * sizeof(uint64_t));
+         report.add("row ends", (rowLengths.capacity() + firstWalls.capacity() +
+                    lastWalls.capacity()) * sizeof(int));
+         report.add("solver", spanBytes);
+      }
+};
+
+#endif
@@ -0,0 +1,225 @@
+#include <algorithm>
+#include <iostream>
+#include <fstream>
+#include <random>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+#include "compactmaze.h"
+#include "memstats.h"
+#include "outofcore.h"
+
+using namespace std;
+
+/*Checks the memory targets of the solvers on a large maze.
+
+Usage: checkmemory [-size n]
+
+Writes each maze in turn to a temporary file, n is 3001
+by default. The mazes come from fixed seeds, so every
+run checks the same mazes. It checks that
+   - outofcore solves a maze of rooms n by n / 2, walls
+     scattered over it with one way through kept clear,
+     in a budget of 4 bytes a cell, at least 16
+     megabytes, without its peak resident size growing
+     by more than the budget
+   - compact solves a perfect maze of about n by n cells,
+     carved by a depth first walk, holding under 2 bytes
+     a cell by the bytes per cell of its MemoryReport
+Prints ok or the first check that failed.*/
+
+bool failed(const string &what)
+{
+   cout << "Failed: " << what << "\n";
+   return false;
+}
+
+void writeMaze(const char *mazeFile, int size)
+{
+   // cells sit on odd rows and columns, the walls between
+   // them are knocked out as the walk goes
+   int cellsAcross = (size - 1) / 2;
+   int width = cellsAcross * 2 + 1;
+   vector<string> rows(width, string(width, '#'));
+
+   static const int dirX[4] = { 0, 0, 1, -1 };
+   static const int dirY[4] = { 1, -1, 0, 0 };
+
+   mt19937 random(2024);
+   vector<int> stack(1, 0);
+   rows[1][1] = ' ';
+   while (!stack.empty())
+   {
+      int cx = stack.back() % cellsAcross;
+      int cy = stack.back() / cellsAcross;
+
+      int open[4], numOpen = 0;
+      for (int d = 0; d < 4; d++)
+      {
+         int nx = cx + dirX[d];
+         int ny = cy + dirY[d];
+         if (nx >= 0 && ny >= 0 && nx < cellsAcross && ny < cellsAcross &&
+               rows[ny * 2 + 1][nx * 2 + 1] == '#')
+         {
+            open[numOpen++] = d;
+         }
+      }
+
+      if (numOpen == 0)
+      {
+         stack.pop_back();
+         continue;
+      }
+
+      int d = open[random() % numOpen];
+      rows[cy * 2 + 1 + dirY[d]][cx * 2 + 1 + dirX[d]] = ' ';
+      rows[(cy + dirY[d]) * 2 + 1][(cx + dirX[d]) * 2 + 1] = ' ';
+      stack.push_back((cy + dirY[d]) * cellsAcross + cx + dirX[d]);
+   }
+
+   rows[1][1] = 's';
+   rows[width - 2][width - 2] = 'f';
+
+   ofstream fout(mazeFile);
+   for (int y = 0; y < width; y++)
+   {
+      fout << rows[y] << "\n";
+   }
+}
+
+void writeRooms(const char *mazeFile, int width, int height)
+{
+   /*Written a row at a time so making it doesn't hold the
+   maze. The way through goes right along each row and
+   down into the next, from the start at the top left to
+   the finish at the bottom right.*/
+   mt19937 random(2025);
+   int across = (width - 3) / (height - 2) + 1;
+
+   ofstream fout(mazeFile);
+   string row(width, '#');
+   fout << row << "\n";
+
+   int wayX = 1;
+   for (int y = 1; y < height - 1; y++)
+   {
+      row.assign(width, '#');
+      for (int x = 1; x < width - 1; x++)
+      {
+         if (random() % 10 >= 3) row[x] = ' ';
+      }
+
+      int downX = min(width - 2, wayX + (int)(random() % (2 * across)));
+      if (y == height - 2) downX = width - 2;
+      for (int x = wayX; x <= downX; x++)
+      {
+         row[x] = ' ';
+      }
+      wayX = downX;
+
+      if (y == 1) row[1] = 's';
+      if (y == height - 2) row[width - 2] = 'f';
+      fout << row << "\n";
+   }
+
+   row.assign(width, '#');
+   fout << row << "\n";
+}
+
+bool checkOutOfCore(const char *mazeFile, int width, int height)
+{
+   // the nodes grow with the cells, so the budget does too
+   size_t budget = max((size_t)16 << 20, (size_t)width * height * 4);
+   size_t before = MemoryReport::peakResident();
+
+   OutOfCoreMaze bigMaze(budget);
+   bigMaze.loadMaze(mazeFile);
+   bigMaze.checkMaze();
+   if (!bigMaze.solve()) return failed("outofcore found no path");
+
+   size_t grown = MemoryReport::peakResident() - before;
+   if (grown > budget)
+   {
+      return failed("outofcore grew by " + to_string(grown) + " bytes, over its budget of " +
+                    to_string(budget));
+   }
+   return true;
+}
+
+bool checkCompact(const char *mazeFile)
+{
+   CompactMaze compact;
+   compact.loadMaze(mazeFile);
+   compact.checkMaze(mazeFile);
+   if (!compact.solve()) return failed("compact found no path");
+
+   MemoryReport report;
+   compact.reportMemory(report);
+   if (report.bytesPerCell() >= 2.0)
+   {
+      report.print(cout);
+      return failed("compact holds 2 or more bytes a cell");
+   }
+   return true;
+}
+
+int main(int argc, char *argv[])
+{
+   int size = 3001;
+
+   for (int i = 1; i < argc; i++)
+   {
+      if (strcmp(argv[i], "-size") == 0 && i + 1 < argc)
+      {
+         size = atoi(argv[++i]);
+      }
+      else
+      {
+         cout << "Usage: checkmemory [-size n]\n";
+         return 0;
+      }
+   }
+
+   // on small mazes the 8 byte row offsets dominate
+   if (size < 101)
+   {
+      cout << "Usage: checkmemory [-size n]\n";
+      cout << "at least 101 cells\n";
+      return 0;
+   }
+
+   char mazeFile[] = "/tmp/checkmemoryXXXXXX";
+   int fd = mkstemp(mazeFile);
+   if (fd < 0)
+   {
+      cout << "Unable to make a temporary file\n";
+      return 1;
+   }
+   close(fd);
+
+   // outofcore first, while the peak is still low
+   bool ok = false;
+   try
+   {
+      writeRooms(mazeFile, size, size / 2);
+      ok = checkOutOfCore(mazeFile, size, size / 2);
+      if (ok)
+      {
+         writeMaze(mazeFile, size);
+         ok = checkCompact(mazeFile);
+      }
+   }
+   catch (const MazeError &e)
+   {
+      ok = failed(e.what());
+   }
+   remove(mazeFile);
+
+   if (!ok) return 1;
+   cout << "ok\n";
+   return 0;
+}
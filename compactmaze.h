@@ -0,0 +1,352 @@
+#ifndef COMPACTMAZE_H
+#define COMPACTMAZE_H
+
+#include <stdint.h>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "mazeerror.h"
+#include "memstats.h"
+#include "rowscan.h"
+
+/********************************************************\
+   one byte per cell maze for the depth first search
+
+   The maze is kept as the text of the file, every cell
+   is its own character and every row ends in a newline,
+   with the offset each row starts at beside it. That is
+   a byte a cell and 9 bytes a row.
+   The search is the one Maze::move does, with the same
+   result, but its stack is kept in the cells it is on.
+   A cell the search has entered holds a breadcrumb byte
+   with the top bit set, the direction back to the cell
+   it came from in the low 2 bits and the next direction
+   to try in the 3 bits above them. Going back up the
+   stack is following those directions, so the search
+   needs no memory of its own. The start is never marked,
+   like in move, and the search can come back through it
+   from each of its neighbours, those visits are the only
+   ones kept apart, on a stack of at most 5.
+\********************************************************/
+
+class CompactMaze
+{
+   private:
+      // private data ====================================
+      std::string cells;
+
+      // rowStart[y] is where row y begins, one more entry
+      // holds the end of the last row
+      std::vector<size_t> rowStart;
+      int height;
+
+      int startX, startY, finishX, finishY;
+      int numStart, numFinish;
+
+      static const unsigned char crumb = 0x80;
+
+      // the visits to the start still on the stack
+      struct StartVisit
+      {
+         int next, back;
+      };
+
+      static const int noBack = -1;
+      static const int maxStartVisits = 5;
+
+      StartVisit startVisits[maxStartVisits];
+      int numStartVisits;
+
+      // private functions ===============================
+
+      static bool validChar(char c)
+      {
+         // the characters Maze takes, digits included
+         return (c == '#' || c == ' ' || c == 's' || c == 'f' ||
+                 (c >= '1' && c <= '9'));
+      }
+
+      static int dirX(int d)
+      {
+         static const int x[4] = { 0, 0, 1, -1 };
+         return x[d];
+      }
+
+      static int dirY(int d)
+      {
+         static const int y[4] = { 1, -1, 0, 0 };
+         return y[d];
+      }
+
+      int rowLength(int y) const
+      {
+         // without the newline
+         return rowStart[y + 1] - rowStart[y] - 1;
+      }
+
+      unsigned char *cellAt(int x, int y)
+      {
+         // NULL past the edge of the maze or the end of a row
+         if (y < 0 || y >= height || x < 0 || x >= rowLength(y)) return NULL;
+         return (unsigned char *)&cells[rowStart[y] + x];
+      }
+
+      bool outsideWalls(int x, int y) const
+      {
+         // same rule as Maze::ifOutside
+         int firstWall, lastWall;
+         findWalls(cells.data() + rowStart[y], rowLength(y), firstWall, lastWall);
+         return (firstWall < 0 || x < firstWall || x > lastWall);
+      }
+
+      static void unableToLoad(const char *filename, const std::string &reason = "")
+      {
+         throw MazeError(reason + "Unable to load maze " + filename + "\n");
+      }
+
+      void finishSearch(bool found, int x, int y)
+      {
+         /*On the way back up move turns every cell on the stack
+         into '.' and the rest of its breadcrumbs into spaces.
+         With no way through the breadcrumbs are left as '!'.*/
+         while (found)
+         {
+            int back;
+            if (x == startX && y == startY)
+            {
+               back = startVisits[--numStartVisits].back;
+               if (back == noBack) break;
+            }
+            else
+            {
+               unsigned char *cell = cellAt(x, y);
+               back = *cell & 3;
+               *cell = '.';
+            }
+            x += dirX(back);
+            y += dirY(back);
+         }
+
+         char mark = found ? ' ' : '!';
+         for (size_t i = 0; i < cells.size(); i++)
+         {
+            if ((unsigned char)cells[i] & crumb) cells[i] = mark;
+         }
+      }
+
+   public:
+
+      /********************************************************\
+         constructor
+      \********************************************************/
+
+      CompactMaze() : height(0), startX(0), startY(0), finishX(0), finishY(0),
+         numStart(0), numFinish(0), numStartVisits(0)
+      {
+      }
+
+      /********************************************************\
+         load and check
+      \********************************************************/
+
+      void loadMaze(const char *filename)
+      {
+         // sized up front so the text isn't grown into twice
+         // the memory, with room for a last newline
+         std::ifstream fin(filename, std::ios::binary);
+         if (!fin) unableToLoad(filename);
+
+         fin.seekg(0, std::ios::end);
+         std::streamoff fileSize = fin.tellg();
+         fin.seekg(0, std::ios::beg);
+         if (fileSize < 0) fileSize = 0;
+
+         std::string text;
+         text.reserve(fileSize + 1);
+         text.resize(fileSize);
+         if (fileSize > 0)
+         {
+            fin.read(&text[0], fileSize);
+            text.resize(fin.gcount());
+         }
+         takeText(text);
+      }
+
+      void takeText(std::string &text)
+      {
+         /*Takes over the text of a maze file, text is left
+         empty. Rows are split where getline would split them
+         and the last one is given a newline if it has none.*/
+         cells.swap(text);
+         text.clear();
+         if (!cells.empty() && cells[cells.size() - 1] != '\n')
+         {
+            // adding to a full string would double its size
+            if (cells.capacity() == cells.size())
+            {
+               std::string padded;
+               padded.reserve(cells.size() + 1);
+               padded = cells;
+               cells.swap(padded);
+            }
+            cells += '\n';
+         }
+
+         rowStart.assign(1, 0);
+         numStart = numFinish = 0;
+         for (size_t i = 0; i < cells.size(); i++)
+         {
+            char c = cells[i];
+            if (c == '\n')
+            {
+               rowStart.push_back(i + 1);
+               continue;
+            }
+            if (!validChar(c))
+            {
+               throw MazeError::invalidCharacter(rowStart.size() - 1);
+            }
+            if (c == 's')
+            {
+               numStart++;
+               startX = i - rowStart.back();
+               startY = rowStart.size() - 1;
+            }
+            if (c == 'f')
+            {
+               numFinish++;
+               finishX = i - rowStart.back();
+               finishY = rowStart.size() - 1;
+            }
+         }
+         height = rowStart.size() - 1;
+         rowStart.shrink_to_fit();
+      }
+
+      void checkMaze(const char *mazeFile)
+      {
+         // same checks and messages as Maze::checkMaze
+         if (numStart > 0 && outsideWalls(startX, startY))
+         {
+            unableToLoad(mazeFile, "Error - start declared outside of maze\n");
+         }
+         if (numFinish > 0 && outsideWalls(finishX, finishY))
+         {
+            unableToLoad(mazeFile, "Error - finish declared outside of maze\n");
+         }
+         if (numStart != 1)
+         {
+            throw MazeError(std::string("Error - ") + (numStart == 0 ? "no" : "multiple") +
+                            " start found in maze\n");
+         }
+         if (numFinish != 1)
+         {
+            throw MazeError(std::string("Error - ") + (numFinish == 0 ? "no" : "multiple") +
+                            " finish found in maze\n");
+         }
+      }
+
+      /********************************************************\
+         solve
+      \********************************************************/
+
+      bool solve()
+      {
+         /*Depth first search trying down, up, right, left, with
+         the maze marked the way move leaves it. Returns false
+         if the finish can't be reached.*/
+         int x = startX;
+         int y = startY;
+         StartVisit first = { 0, noBack };
+         startVisits[0] = first;
+         numStartVisits = 1;
+
+         while (true)
+         {
+            bool onStart = (x == startX && y == startY);
+            unsigned char *cell = onStart ? NULL : cellAt(x, y);
+            int next = onStart ? startVisits[numStartVisits - 1].next : (*cell >> 2) & 7;
+
+            if (next == 4)
+            {
+               // every way out failed, go back the way we came
+               int back;
+               if (onStart)
+               {
+                  back = startVisits[--numStartVisits].back;
+                  if (back == noBack)
+                  {
+                     finishSearch(false, x, y);
+                     return false;
+                  }
+               }
+               else
+               {
+                  back = *cell & 3;
+               }
+               x += dirX(back);
+               y += dirY(back);
+               continue;
+            }
+
+            if (onStart)
+            {
+               startVisits[numStartVisits - 1].next++;
+            }
+            else
+            {
+               *cell += 1 << 2;
+            }
+
+            // d ^ 1 is the way back, down and up are 0 and 1,
+            // right and left 2 and 3
+            int nx = x + dirX(next);
+            int ny = y + dirY(next);
+            unsigned char *nextCell = cellAt(nx, ny);
+            if (nextCell == NULL) continue;
+
+            if (*nextCell == 'f')
+            {
+               finishSearch(true, x, y);
+               return true;
+            }
+
+            if (*nextCell == ' ')
+            {
+               *nextCell = crumb | (next ^ 1);
+               x = nx;
+               y = ny;
+            }
+            else if (*nextCell == 's')
+            {
+               StartVisit visit = { 0, next ^ 1 };
+               startVisits[numStartVisits++] = visit;
+               x = nx;
+               y = ny;
+            }
+         }
+      }
+
+      /********************************************************\
+         output and memory
+      \********************************************************/
+
+      void printMaze() const
+      {
+         // the same output as Maze::printMaze
+         std::cout.write(cells.data(), cells.size());
+      }
+
+      void reportMemory(MemoryReport &report) const
+      {
+         // the search itself only keeps the visits to the start
+         report.setCells(cells.size() - height);
+         report.add("cells", cells.capacity());
+         report.add("row offsets", rowStart.capacity() * sizeof(size_t));
+         report.add("solver", sizeof(startVisits));
+      }
+};
+
+#endif
@@ -0,0 +1,488 @@
+#ifndef CONCURRENTBINTREE_H_
+#define CONCURRENTBINTREE_H_
+
+#include <stdexcept>
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "binnode.h"
+
+/********************************************************\
+   balanced binary tree that many threads can share
+
+   Readers never lock. Writers take one mutex between
+   them and never change a node a reader might be looking
+   at: an insert or erase copies the nodes on its path
+   (and any it rotates) into new nodes and then swaps the
+   new root in with one atomic store. A reader sees either
+   the old tree or the new one, never a mix.
+   Nodes that fall out of the tree are freed RCU style.
+   Each read bumps one of two reader counters and the
+   writer waits for both to drain in turn before freeing,
+   so nothing is freed while a reader that could still
+   reach it is running. Freeing is put off until a batch
+   of nodes has built up so writers rarely have to wait.
+   Items are copied when their path is copied so dataType
+   must be copyable, and lookups hand back a copy of the
+   item as no pointer into the tree is safe to keep. An
+   item with more to it than a key should be a sharedItem
+   so those copies stay cheap.
+\********************************************************/
+
+/********************************************************\
+   a key with its payload held by a shared_ptr
+
+   Copying one copies the key and bumps a count, however
+   big the payload. A reader keeps the payload alive for
+   as long as it holds the copy find gave it, even once
+   the item is erased. Items compare by key and the key
+   alone is enough to find or erase one.
+\********************************************************/
+
+template <typename keyType, typename payloadType> class sharedItem
+{
+   private:
+      keyType itemKey;
+      std::shared_ptr<const payloadType> itemPayload;
+
+   public:
+      sharedItem() : itemKey()
+      {
+      }
+
+      sharedItem(const keyType &key, const payloadType &payload) :
+         itemKey(key), itemPayload(std::make_shared<const payloadType>(payload))
+      {
+      }
+
+      sharedItem(const keyType &key, payloadType &&payload) :
+         itemKey(key), itemPayload(std::make_shared<const payloadType>(std::move(payload)))
+      {
+      }
+
+      const keyType& key() const
+      {
+         return itemKey;
+      }
+
+      const payloadType& payload() const
+      {
+         return *itemPayload;
+      }
+
+      bool operator < (const sharedItem &other) const
+      {
+         return itemKey < other.itemKey;
+      }
+
+      bool operator == (const sharedItem &other) const
+      {
+         return itemKey == other.itemKey;
+      }
+
+      friend bool operator < (const keyType &key, const sharedItem &item)
+      {
+         return key < item.itemKey;
+      }
+
+      friend bool operator == (const keyType &key, const sharedItem &item)
+      {
+         return key == item.itemKey;
+      }
+};
+
+template <typename dataType> class concurrentBintree
+{
+   private:
+      struct node
+      {
+         dataType nodeData;
+         node *left, *right;
+         int height;
+
+         // write that made this node, a node made by the write
+         // in progress can't be seen yet so it may be changed
+         unsigned long version;
+
+         node(const dataType &dataItem, node *l, node *r, unsigned long v) :
+            nodeData(dataItem), left(l), right(r), height(1), version(v)
+         {
+         }
+      };
+
+      // retired nodes are freed once this many have built up
+      static const size_t retireBatch = 1024;
+
+      // private data ====================================
+      std::atomic<node*> root;
+      std::atomic<int> numItems;
+
+      // readers count themselves in one of two counters, kept on
+      // separate cache lines from each other and from root
+      struct alignas(64) readerCount
+      {
+         std::atomic<long> count;
+      };
+      mutable readerCount readers[2];
+      mutable std::atomic<int> readerPhase;
+
+      // writers only
+      std::mutex writeLock;
+      unsigned long writeVersion;
+      std::vector<node*> retired;
+
+      // private functions ===============================
+
+      int readLock() const
+      {
+         int phase = readerPhase.load();
+         readers[phase].count.fetch_add(1);
+         return phase;
+      }
+
+      void readUnlock(int phase) const
+      {
+         readers[phase].count.fetch_sub(1);
+      }
+
+      void waitForReaders()
+      {
+         // a reader may have read the phase just before it was
+         // flipped and counted itself later, so flip and drain
+         // twice to be sure every reader that started before
+         // the new root went in has finished
+         for (int i = 0; i < 2; i++)
+         {
+            int old = readerPhase.load();
+            readerPhase.store(1 - old);
+            while (readers[old].count.load() != 0)
+            {
+               std::this_thread::yield();
+            }
+         }
+      }
+
+      void reclaim()
+      {
+         waitForReaders();
+         for (size_t i = 0; i < retired.size(); i++)
+         {
+            delete retired[i];
+         }
+         retired.clear();
+      }
+
+      static int heightOf(const node *n)
+      {
+         if (n == NULL) return 0;
+         else return n->height;
+      }
+
+      static void updateHeight(node *n)
+      {
+         int l = heightOf(n->left);
+         int r = heightOf(n->right);
+         n->height = 1 + (l >= r ? l : r);
+      }
+
+      node* makeNode(const dataType &dataItem, node *l, node *r)
+      {
+         node *n = new node(dataItem, l, r, writeVersion);
+         updateHeight(n);
+         return n;
+      }
+
+      node* withChildren(node *n, node *l, node *r)
+      {
+         // n with new subtrees. A node from this write is changed
+         // in place, an older one may be in use by readers so it
+         // is copied and retired.
+         if (n->version == writeVersion)
+         {
+            n->left = l;
+            n->right = r;
+            updateHeight(n);
+            return n;
+         }
+
+         retired.push_back(n);
+         return makeNode(n->nodeData, l, r);
+      }
+
+      node* rotateClockwise(node *n)
+      {
+         node *l = n->left;
+         node *down = withChildren(n, l->right, n->right);
+         return withChildren(l, l->left, down);
+      }
+
+      node* rotateAntiClockwise(node *n)
+      {
+         node *r = n->right;
+         node *down = withChildren(n, n->left, r->left);
+         return withChildren(r, down, r->right);
+      }
+
+      node* rebalance(node *n)
+      {
+         // same rotations as binNode::rebalance
+         int slope = heightOf(n->left) - heightOf(n->right);
+
+         if (slope > 1)
+         {
+            node *l = n->left;
+            if (heightOf(l->left) < heightOf(l->right))
+            {
+               n = withChildren(n, rotateAntiClockwise(l), n->right);
+            }
+            return rotateClockwise(n);
+         }
+         if (slope < -1)
+         {
+            node *r = n->right;
+            if (heightOf(r->left) > heightOf(r->right))
+            {
+               n = withChildren(n, n->left, rotateClockwise(r));
+            }
+            return rotateAntiClockwise(n);
+         }
+         return n;
+      }
+
+      node* insertItem(node *n, const dataType &dataItem)
+      {
+         // nothing is copied until the way down has been walked,
+         // so a duplicate leaves the tree untouched
+         if (n == NULL) return makeNode(dataItem, NULL, NULL);
+
+         if (n->nodeData == dataItem)
+         {
+            throw std::invalid_argument("dataItem already in tree");
+         }
+
+         if (dataItem < n->nodeData)
+         {
+            node *l = insertItem(n->left, dataItem);
+            return rebalance(withChildren(n, l, n->right));
+         }
+         else
+         {
+            node *r = insertItem(n->right, dataItem);
+            return rebalance(withChildren(n, n->left, r));
+         }
+      }
+
+      node* eraseMin(node *n, node* &minNode)
+      {
+         // take the left most node out of subtree n
+         if (n->left == NULL)
+         {
+            minNode = n;
+            return n->right;
+         }
+
+         node *l = eraseMin(n->left, minNode);
+         return rebalance(withChildren(n, l, n->right));
+      }
+
+      template <typename keyType>
+      node* eraseItem(node *n, const keyType &delData)
+      {
+         if (n == NULL)
+         {
+            throw std::invalid_argument("delItem not in tree");
+         }
+
+         if (delData == n->nodeData)
+         {
+            retired.push_back(n);
+            if (n->left == NULL) return n->right;
+            if (n->right == NULL) return n->left;
+
+            // the next item along takes the erased item's place
+            node *next;
+            node *r = eraseMin(n->right, next);
+            retired.push_back(next);
+            return rebalance(makeNode(next->nodeData, n->left, r));
+         }
+
+         if (delData < n->nodeData)
+         {
+            node *l = eraseItem(n->left, delData);
+            return rebalance(withChildren(n, l, n->right));
+         }
+         else
+         {
+            node *r = eraseItem(n->right, delData);
+            return rebalance(withChildren(n, n->left, r));
+         }
+      }
+
+      void publish(node *newRoot)
+      {
+         root.store(newRoot);
+         if (retired.size() >= retireBatch) reclaim();
+      }
+
+      static void deleteTree(node *n)
+      {
+         pathStack<node*> todo;
+         if (n != NULL) todo.push(n);
+
+         while (!todo.empty())
+         {
+            node *next = todo.pop();
+            if (next->left != NULL) todo.push(next->left);
+            if (next->right != NULL) todo.push(next->right);
+            delete next;
+         }
+      }
+
+   public:
+      /*******************************************************\
+         constructors & destructors
+      \*******************************************************/
+
+      concurrentBintree() : root(NULL), numItems(0), readerPhase(0), writeVersion(0)
+      {
+         readers[0].count.store(0);
+         readers[1].count.store(0);
+      }
+
+      // the tree owns its nodes and threads hold it by address
+      concurrentBintree(const concurrentBintree<dataType> &other) = delete;
+      concurrentBintree& operator = (const concurrentBintree<dataType> &other) = delete;
+
+      // no other thread may be using the tree by now
+      ~concurrentBintree()
+      {
+         deleteTree(root.load());
+         for (size_t i = 0; i < retired.size(); i++)
+         {
+            delete retired[i];
+         }
+      }
+
+      /*******************************************************\
+          tree information functions
+      \*******************************************************/
+
+      bool empty() const
+      {
+         return (numItems.load() == 0);
+      }
+
+      int size() const
+      {
+         return numItems.load();
+      }
+
+      int treeHeight() const
+      {
+         int phase = readLock();
+         int height = heightOf(root.load());
+         readUnlock(phase);
+         return height;
+      }
+
+      /*******************************************************\
+         writers, one at a time
+      \*******************************************************/
+
+      void insert(const dataType &newData)
+      {
+         std::lock_guard<std::mutex> guard(writeLock);
+         writeVersion++;
+
+         publish(insertItem(root.load(), newData));
+         numItems++;
+      }
+
+      template <typename keyType>
+      void erase(const keyType &delData)
+      {
+         std::lock_guard<std::mutex> guard(writeLock);
+         writeVersion++;
+
+         publish(eraseItem(root.load(), delData));
+         numItems--;
+      }
+
+      void synchronize()
+      {
+         // free every retired node now rather than waiting for a
+         // full batch
+         std::lock_guard<std::mutex> guard(writeLock);
+         reclaim();
+      }
+
+      /*******************************************************\
+         readers, any number at once and never blocked
+      \*******************************************************/
+
+      template <typename keyType>
+      bool find(const keyType &findData, dataType &foundData) const
+      {
+         // copies the item matching findData into foundData,
+         // returns false if there is none
+         int phase = readLock();
+
+         const node *n = root.load();
+         while (n != NULL && !(findData == n->nodeData))
+         {
+            if (findData < n->nodeData) n = n->left;
+            else n = n->right;
+         }
+         if (n != NULL) foundData = n->nodeData;
+
+         readUnlock(phase);
+         return (n != NULL);
+      }
+
+      template <typename keyType>
+      bool contains(const keyType &findData) const
+      {
+         int phase = readLock();
+
+         const node *n = root.load();
+         while (n != NULL && !(findData == n->nodeData))
+         {
+            if (findData < n->nodeData) n = n->left;
+            else n = n->right;
+         }
+
+         readUnlock(phase);
+         return (n != NULL);
+      }
+
+      template <typename visitType>
+      void forEach(visitType visit) const
+      {
+         // calls visit on every item in order, all from the one
+         // version of the tree. visit must not write to the tree.
+         int phase = readLock();
+
+         pathStack<const node*> path;
+         const node *n = root.load();
+         while (n != NULL || !path.empty())
+         {
+            while (n != NULL)
+            {
+               path.push(n);
+               n = n->left;
+            }
+            n = path.pop();
+            visit(n->nodeData);
+            n = n->right;
+         }
+
+         readUnlock(phase);
+      }
+};
+
+#endif
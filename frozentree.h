@@ -0,0 +1,240 @@
+#ifndef FROZENTREE_H_
+#define FROZENTREE_H_
+
+#include <cstddef>
+#include <iostream>
+#include <iterator>
+#include <utility>
+#include <vector>
+
+/********************************************************\
+   read only binary tree in an implicit array layout
+
+   Made by bintree::freeze() once a tree will not change
+   shape again. Items are kept in Eytzinger (breadth first)
+   order in one array, the children of item k are items
+   2k and 2k+1, so there are no pointers to chase. A
+   search goes down the array without branching on the
+   compare and prefetches the items four levels further
+   down while it waits on the current one.
+   Items can still be changed through find as long as
+   their place in the order stays the same.
+\********************************************************/
+
+template <typename dataType> class frozenTree
+{
+   private:
+      // item 0 is unused so the children arithmetic works out
+      std::vector<dataType> items;
+      int numItems;
+
+      // private functions ===============================
+
+      template <typename iterType>
+      void fill(size_t k, iterType &next)
+      {
+         // an in-order walk of the implicit tree visits the
+         // slots in sorted order
+         if (k > (size_t)numItems) return;
+
+         fill(2 * k, next);
+         items[k] = std::move(*next);
+         ++next;
+         fill(2 * k + 1, next);
+      }
+
+      template <typename keyType>
+      size_t search(const keyType &findData) const
+      {
+         // index of the first item not less than findData,
+         // 0 if there is none
+         size_t k = 1;
+         size_t n = numItems;
+         const dataType *base = items.data();
+
+         while (k <= n)
+         {
+            if (16 * k <= n) __builtin_prefetch(base + 16 * k);
+
+            // findData > item without needing operator > on dataType
+            bool goRight = !(findData < base[k]) && !(findData == base[k]);
+            k = 2 * k + goRight;
+         }
+
+         // undo the right turns taken after the last left turn
+         k >>= __builtin_ffsll(~k);
+         return k;
+      }
+
+   public:
+
+      /*******************************************************\
+         iterator, walks the items in sorted order
+      \*******************************************************/
+
+      template <typename valueType, typename treeType> class frozenIterator
+      {
+         private:
+            treeType *tree;
+            size_t k;
+
+         public:
+            typedef std::forward_iterator_tag iterator_category;
+            typedef dataType value_type;
+            typedef std::ptrdiff_t difference_type;
+            typedef valueType* pointer;
+            typedef valueType& reference;
+
+            frozenIterator(treeType *t, size_t index) : tree(t), k(index)
+            {
+            }
+
+            reference operator * () const
+            {
+               return tree->items[k];
+            }
+
+            pointer operator -> () const
+            {
+               return &(tree->items[k]);
+            }
+
+            frozenIterator& operator ++ ()
+            {
+               size_t n = tree->numItems;
+               if (2 * k + 1 <= n)
+               {
+                  // left most item of the right subtree
+                  k = 2 * k + 1;
+                  while (2 * k <= n) k = 2 * k;
+               }
+               else
+               {
+                  // climb while coming up from a right child,
+                  // reaching 0 means the end
+                  while (k & 1) k >>= 1;
+                  k >>= 1;
+               }
+               return *this;
+            }
+
+            frozenIterator operator ++ (int)
+            {
+               frozenIterator old(*this);
+               ++(*this);
+               return old;
+            }
+
+            bool operator == (const frozenIterator &other) const
+            {
+               return k == other.k;
+            }
+
+            bool operator != (const frozenIterator &other) const
+            {
+               return k != other.k;
+            }
+      };
+
+      typedef frozenIterator<dataType, frozenTree<dataType> > iterator;
+      typedef frozenIterator<const dataType, const frozenTree<dataType> > const_iterator;
+
+      /*******************************************************\
+         constructors
+      \*******************************************************/
+
+      frozenTree() : items(1), numItems(0)
+      {
+      }
+
+      template <typename iterType>
+      frozenTree(iterType first, int count) : items(count + 1), numItems(count)
+      {
+         // build from count sorted items, moving them in if
+         // first is a move iterator
+         fill(1, first);
+      }
+
+      /*******************************************************\
+         tree information functions
+      \*******************************************************/
+
+      bool empty() const
+      {
+         return (numItems == 0);
+      }
+
+      int size() const
+      {
+         return numItems;
+      }
+
+      size_t memoryUsed() const
+      {
+         // bytes held by the item array, not anything the items own
+         return items.capacity() * sizeof(dataType);
+      }
+
+      /*******************************************************\
+         find functions, same as bintree. The key can be a
+         dataType or anything with key < data and key == data
+      \*******************************************************/
+
+      template <typename keyType>
+      dataType* find(const keyType &findData)
+      {
+         size_t k = search(findData);
+         if (k == 0 || !(findData == items[k])) return NULL;
+         return &items[k];
+      }
+
+      template <typename keyType>
+      const dataType* findConst(const keyType &findData) const
+      {
+         size_t k = search(findData);
+         if (k == 0 || !(findData == items[k])) return NULL;
+         return &items[k];
+      }
+
+      /*******************************************************\
+         iterators
+      \*******************************************************/
+
+      iterator begin()
+      {
+         size_t k = 1;
+         while (2 * k <= (size_t)numItems) k = 2 * k;
+         return iterator(this, numItems == 0 ? 0 : k);
+      }
+
+      iterator end()
+      {
+         return iterator(this, 0);
+      }
+
+      const_iterator begin() const
+      {
+         size_t k = 1;
+         while (2 * k <= (size_t)numItems) k = 2 * k;
+         return const_iterator(this, numItems == 0 ? 0 : k);
+      }
+
+      const_iterator end() const
+      {
+         return const_iterator(this, 0);
+      }
+
+      /*******************************************************\
+         print function, assumes dataType has toString()
+      \*******************************************************/
+
+      void print() const
+      {
+         for (const_iterator it = begin(); it != end(); ++it)
+         {
+            std::cout << it->toString() << "\n";
+         }
+      }
+};
+
+#endif
@@ -0,0 +1,692 @@
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+#include "maze.h"
+#include "compactmaze.h"
+#include "mazegrid.h"
+#include "jumppoint.h"
+#include "gridbfs.h"
+#include "griddijkstra.h"
+#include "gridmulti.h"
+#include "solverengine.h"
+#include "bitmaze.h"
+#include "outofcore.h"
+
+using namespace std;
+
+/*Fuzz target that runs any bytes through every loader
+and solver and checks they agree with each other.
+
+Build it for libFuzzer:
+   clang++ -std=c++11 -g -O1 -fsanitize=fuzzer,address -pthread
+           -o fuzzmaze fuzzmaze.cpp
+or on its own, to replay crashes or try random mazes:
+   g++ -std=c++11 -O2 -pthread -DFUZZ_STANDALONE -o fuzzmaze fuzzmaze.cpp
+   fuzzmaze [-random n] [mazefile ...]
+
+For every input it checks that
+   - loading the rows in chunks on several threads gives
+     the same maze or the same error as one thread
+   - Maze, CompactMaze, BitMaze and OutOfCoreMaze reject
+     the same mazes with the same message, digits aside
+     for the last two as they don't accept them
+   - every solver agrees on whether there is a path and
+     every path found goes from s to f over open cells
+   - dfs, stepped dfs and compact leave exactly the same
+     maze, and so does the engine with its default
+     policies, breadcrumbs aside when there is no path
+   - bfs, jps, multi, bitplane and outofcore all find
+     paths of the same length, and so does dijkstra when
+     there are no digits. With digits dijkstra's path
+     costs no more than the bfs one.
+   - a maze with several starts and finishes gets each
+     start's nearest finish out of multi
+A failed check prints the maze and aborts, which is
+what libFuzzer looks for.*/
+
+//the recursive dfs needs a stack frame per cell
+static const size_t maxInput = 1 << 14;
+
+//multi is checked against a bfs per start and finish
+static const int maxPairs = 64;
+
+static string mazeText;
+
+void fail(const string &what)
+{
+   cerr << "fuzzmaze: " << what << "\n-- maze --\n" << mazeText << "\n----------\n";
+   abort();
+}
+
+void check(bool ok, const string &what)
+{
+   if (!ok)
+   {
+      fail(what);
+   }
+}
+
+/********************************************************\
+   the maze as a file, for the loaders that read one
+\********************************************************/
+
+static string mazePath;
+
+void removeMazeFile()
+{
+   remove(mazePath.c_str());
+}
+
+const char *writeMazeFile(const string &text)
+{
+   if (mazePath.empty())
+   {
+      char name[] = "/tmp/fuzzmazeXXXXXX";
+      int fd = mkstemp(name);
+      if (fd < 0)
+      {
+         cerr << "fuzzmaze: unable to create a maze file\n";
+         abort();
+      }
+      close(fd);
+      mazePath = name;
+      atexit(removeMazeFile);
+   }
+
+   ofstream fout(mazePath.c_str(), ios::binary | ios::trunc);
+   fout.write(text.data(), text.size());
+   fout.close();
+   check(!fout.fail(), "unable to write the maze file");
+   return mazePath.c_str();
+}
+
+/********************************************************\
+   output of the print functions
+\********************************************************/
+
+class CaptureOutput
+{
+   //cout goes into a string until this goes out of scope
+   private:
+      ostringstream captured;
+      streambuf *original;
+
+   public:
+      CaptureOutput() : original(cout.rdbuf(captured.rdbuf()))
+      {
+      }
+
+      ~CaptureOutput()
+      {
+         cout.rdbuf(original);
+      }
+
+      string text() const
+      {
+         return captured.str();
+      }
+};
+
+/********************************************************\
+   path checks
+\********************************************************/
+
+template <typename GridType>
+void checkPath(const GridType &grid, const vector<GridPoint> &path,
+               const GridPoint &start, const GridPoint &finish,
+               bool weighted, bool diagonal, const string &solver)
+{
+   /*The path has to run from start to finish a step at a
+   time over open cells, or cells with a cost for a
+   weighted solver. A diagonal step can't cut a corner.*/
+   check(!path.empty(), solver + " found an empty path");
+   check(path.front().x == start.x && path.front().y == start.y,
+         solver + " path doesn't begin at the start");
+   check(path.back().x == finish.x && path.back().y == finish.y,
+         solver + " path doesn't end at the finish");
+
+   for (unsigned int i = 0; i < path.size(); i++)
+   {
+      const GridPoint &p = path[i];
+      bool open = weighted ? grid.cellCost(p.x, p.y) > 0 : grid.isOpen(p.x, p.y);
+      check(open, solver + " path goes through a wall");
+
+      if (i == 0)
+      {
+         continue;
+      }
+
+      int dx = abs(p.x - path[i - 1].x);
+      int dy = abs(p.y - path[i - 1].y);
+      if (diagonal && dx == 1 && dy == 1)
+      {
+         check(grid.isOpen(p.x, path[i - 1].y) && grid.isOpen(path[i - 1].x, p.y),
+               solver + " path cuts a corner");
+      }
+      else
+      {
+         check(dx + dy == 1, solver + " path jumps between cells");
+      }
+   }
+}
+
+int pathCost(const MazeGrid &grid, const vector<GridPoint> &path)
+{
+   //what dijkstra adds up, the cost of every cell stepped onto
+   int cost = 0;
+   for (unsigned int i = 1; i < path.size(); i++)
+   {
+      cost += grid.cellCost(path[i].x, path[i].y);
+   }
+   return cost;
+}
+
+int countPathCells(const string &printed, const string &plain)
+{
+   /*Number of '.' in a printed maze, which must otherwise
+   be the same as the maze printed with no path*/
+   check(printed.size() == plain.size(), "printed maze changed size");
+
+   int numPath = 0;
+   for (size_t i = 0; i < printed.size(); i++)
+   {
+      if (printed[i] == '.' && plain[i] == ' ')
+      {
+         numPath++;
+      }
+      else
+      {
+         check(printed[i] == plain[i], "printed maze changed outside the path");
+      }
+   }
+   return numPath;
+}
+
+/********************************************************\
+   solvers on the flat grid
+\********************************************************/
+
+template <typename GridType, typename Connectivity, typename Order,
+          typename Visited>
+string checkEngine(const GridType &grid, const GridPoint &start,
+                   const GridPoint &finish, bool solvable, const string &solver)
+{
+   /*Every policy finds a path when dfs does, eight way too
+   as a diagonal step needs both cells beside it open.
+   Returns the maze printed with the path.*/
+   SolverEngine<GridType, Connectivity, Order, Visited> engine(grid);
+   vector<GridPoint> path;
+   bool found = engine.solve(start.x, start.y, finish.x, finish.y, path);
+
+   check(found == solvable, solver + " disagrees with dfs on solvability");
+
+   GridType marked = grid;
+   if (found)
+   {
+      checkPath(grid, path, start, finish, false, Connectivity::numDirs == 8, solver);
+      marked.markPath(path);
+   }
+
+   CaptureOutput output;
+   marked.print();
+   return output.text();
+}
+
+template <typename SolverType, typename GridType>
+int checkShortest(const GridType &grid, const GridPoint &start,
+                  const GridPoint &finish, bool solvable, const string &solver)
+{
+   //steps on the path found, -1 if there isn't one
+   SolverType shortest(grid);
+   vector<GridPoint> path;
+   bool found = shortest.solve(start.x, start.y, finish.x, finish.y, path);
+
+   check(found == solvable, solver + " disagrees with dfs on solvability");
+   if (!found)
+   {
+      return -1;
+   }
+
+   checkPath(grid, path, start, finish, false, false, solver);
+   return path.size() - 1;
+}
+
+void checkSolvers(const Maze &maze, const string &text, const char *mazeFile,
+                  bool hasDigits)
+{
+   MazeGrid grid;
+   TiledMazeGrid tiled;
+   maze.copyToGrid(grid);
+   maze.copyToGrid(tiled);
+
+   GridPoint start(0, 0), finish(0, 0);
+   grid.findCell('s', start.x, start.y);
+   grid.findCell('f', finish.x, finish.y);
+
+   string plain;
+   {
+      CaptureOutput output;
+      grid.print();
+      plain = output.text();
+   }
+
+   //the original search is the reference for the rest
+   string dfs;
+   {
+      Maze solved = maze;
+      CaptureOutput output;
+      solved.findPathThroughMaze();
+      solved.printMaze();
+      dfs = output.text();
+   }
+
+   Maze stepped = maze;
+   MazeSolveTask task(stepped);
+   while (task.step(1) == MazeSolveTask::running)
+   {
+   }
+   bool solvable = (task.getState() == MazeSolveTask::solved);
+   {
+      CaptureOutput output;
+      stepped.printMaze();
+      check(output.text() == dfs, "stepped dfs marked a different path");
+   }
+
+   CompactMaze compact;
+   string compactText = text;
+   compact.takeText(compactText);
+   compact.checkMaze(mazeFile);
+   check(compact.solve() == solvable, "compact disagrees with dfs on solvability");
+   {
+      CaptureOutput output;
+      compact.printMaze();
+      check(output.text() == dfs, "compact marked a different path to dfs");
+   }
+
+   //the engine's defaults follow the same path as dfs, which
+   //leaves its breadcrumbs behind when there is no path
+   if (!solvable)
+   {
+      for (char &c : dfs)
+      {
+         if (c == '!')
+         {
+            c = ' ';
+         }
+      }
+   }
+   check(checkEngine<MazeGrid, FourConnected, DownUpRightLeft, ByteVisited>(
+            grid, start, finish, solvable, "engine") == dfs,
+         "engine marked a different path to dfs");
+   check(checkEngine<TiledMazeGrid, FourConnected, DownUpRightLeft, BitVisited>(
+            tiled, start, finish, solvable, "engine tiled bits") == dfs,
+         "tiled engine marked a different path to dfs");
+   checkEngine<MazeGrid, FourConnected, RightDownLeftUp, BitVisited>(
+      grid, start, finish, solvable, "engine rdlu");
+   checkEngine<MazeGrid, EightConnected, DownUpRightLeft, ByteVisited>(
+      grid, start, finish, solvable, "engine 8");
+   checkEngine<TiledMazeGrid, EightConnected, RightDownLeftUp, BitVisited>(
+      tiled, start, finish, solvable, "engine tiled 8 rdlu");
+
+   //the shortest path solvers
+   int steps = checkShortest< GridBfsSolver<MazeGrid> >(grid, start, finish, solvable, "bfs");
+   check(checkShortest< GridBfsSolver<TiledMazeGrid> >(tiled, start, finish, solvable,
+            "bfs tiled") == steps, "bfs tiled found a different length");
+   check(checkShortest<JumpPointSolver>(grid, start, finish, solvable, "jps") == steps,
+         "jps found a different length to bfs");
+
+   GridMultiSolver<MazeGrid> multi(grid);
+   multi.solve(vector<GridPoint>(1, finish), vector<GridPoint>(1, start));
+   check(multi.reached(start) == solvable, "multi disagrees with dfs on solvability");
+   if (solvable)
+   {
+      vector<GridPoint> path;
+      multi.pathFrom(start, path);
+      checkPath(grid, path, start, finish, false, false, "multi");
+      check(multi.distance(start) == steps, "multi found a different length to bfs");
+      check((int)path.size() - 1 == steps, "multi path is not its distance");
+   }
+
+   GridDijkstraSolver<MazeGrid> dijkstra(grid);
+   vector<GridPoint> path;
+   bool found = dijkstra.solve(start.x, start.y, finish.x, finish.y, path);
+   if (found)
+   {
+      checkPath(grid, path, start, finish, true, false, "dijkstra");
+   }
+   if (!hasDigits)
+   {
+      check(found == solvable, "dijkstra disagrees with dfs on solvability");
+      check(!found || (int)path.size() - 1 == steps,
+            "dijkstra found a different length to bfs");
+      check(!found || pathCost(grid, path) == steps, "dijkstra cost is not its length");
+   }
+   else if (solvable)
+   {
+      //digit cells only add ways through
+      check(found, "dijkstra missed a path bfs found");
+      check(pathCost(grid, path) <= steps, "dijkstra path costs more than bfs");
+   }
+
+   if (hasDigits)
+   {
+      //bitplane and outofcore don't take digits
+      return;
+   }
+
+   BitMaze bitMaze;
+   bitMaze.loadMaze(mazeFile);
+   bitMaze.checkMaze(mazeFile);
+   found = bitMaze.solve(path);
+   check(found == solvable, "bitplane disagrees with dfs on solvability");
+   if (found)
+   {
+      checkPath(grid, path, start, finish, false, false, "bitplane");
+      check((int)path.size() - 1 == steps, "bitplane found a different length to bfs");
+      bitMaze.markPath(path);
+   }
+   {
+      CaptureOutput output;
+      bitMaze.printMaze();
+      check(countPathCells(output.text(), plain) == (found ? steps - 1 : 0),
+            "bitplane printed a different path");
+   }
+
+   //bands of a few rows so paths cross between them
+   OutOfCoreMaze bigMaze(64, 1 + rand() % 3);
+   bigMaze.loadMaze(mazeFile);
+   bigMaze.checkMaze();
+   found = bigMaze.solve();
+   check(found == solvable, "outofcore disagrees with dfs on solvability");
+   {
+      CaptureOutput output;
+      bigMaze.printMaze();
+      check(countPathCells(output.text(), plain) == (found ? steps - 1 : 0),
+            "outofcore found a different length to bfs");
+   }
+}
+
+void checkMultiple(const string &text, const char *mazeFile)
+{
+   /*A maze with several starts or finishes. Each start
+   multi reaches has to be as far from its nearest finish
+   as the closest finish bfs can find.*/
+   Maze maze;
+   try
+   {
+      maze.insertRowsIntoTree(text, 1);
+      maze.checkMaze(mazeFile, true);
+   }
+   catch (const MazeError &)
+   {
+      return;
+   }
+
+   MazeGrid grid;
+   maze.copyToGrid(grid);
+
+   vector<GridPoint> starts, finishes;
+   grid.findCells('s', starts);
+   grid.findCells('f', finishes);
+   if ((int)(starts.size() * finishes.size()) > maxPairs)
+   {
+      return;
+   }
+
+   GridMultiSolver<MazeGrid> multi(grid);
+   multi.solve(finishes, starts);
+
+   for (const GridPoint &start : starts)
+   {
+      int closest = -1;
+      for (const GridPoint &finish : finishes)
+      {
+         GridBfsSolver<MazeGrid> bfs(grid);
+         vector<GridPoint> path;
+         if (bfs.solve(start.x, start.y, finish.x, finish.y, path) &&
+               (closest < 0 || (int)path.size() - 1 < closest))
+         {
+            closest = path.size() - 1;
+         }
+      }
+
+      check(multi.reached(start) == (closest >= 0),
+            "multi disagrees with bfs on which starts get out");
+      if (closest < 0)
+      {
+         continue;
+      }
+
+      vector<GridPoint> path;
+      multi.pathFrom(start, path);
+      checkPath(grid, path, start, finishes[multi.nearestFinish(start)],
+                false, false, "multi");
+      check(multi.distance(start) == closest, "multi missed the nearest finish");
+      check((int)path.size() - 1 == closest, "multi path is not its distance");
+   }
+}
+
+/********************************************************\
+   loading
+\********************************************************/
+
+template <typename LoadType>
+string loadError(LoadType load)
+{
+   //the message a loader stops with, empty if it doesn't
+   try
+   {
+      load();
+   }
+   catch (const MazeError &error)
+   {
+      return error.what();
+   }
+   return "";
+}
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size)
+{
+   if (size > maxInput)
+   {
+      return 0;
+   }
+
+   mazeText.assign((const char *)data, size);
+   const string &text = mazeText;
+   bool hasDigits = (text.find_first_of("123456789") != string::npos);
+   const char *mazeFile = writeMazeFile(text);
+
+   Maze maze;
+   string error = loadError([&]()
+   {
+      maze.insertRowsIntoTree(text, 1);
+      maze.checkMaze(mazeFile);
+   });
+
+   //chunks of a few bytes on several threads, merged back
+   //into the same rows as one thread loads
+   Maze chunked;
+   string chunkedError = loadError([&]()
+   {
+      chunked.insertRowsIntoTree(text, 4, 8);
+      chunked.checkMaze(mazeFile);
+   });
+   check(chunkedError == error, "chunked load stopped with \"" + chunkedError +
+         "\" and one thread with \"" + error + "\"");
+   if (error.empty())
+   {
+      string serialRows, chunkedRows;
+      {
+         CaptureOutput output;
+         maze.printMaze();
+         serialRows = output.text();
+      }
+      {
+         CaptureOutput output;
+         chunked.printMaze();
+         chunkedRows = output.text();
+      }
+      check(chunkedRows == serialRows, "chunked load gave different rows to one thread");
+   }
+
+   string compactError = loadError([&]()
+   {
+      CompactMaze compact;
+      string compactText = text;
+      compact.takeText(compactText);
+      compact.checkMaze(mazeFile);
+   });
+   check(compactError == error, "compact stopped with \"" + compactError +
+         "\" and dfs with \"" + error + "\"");
+
+   if (!hasDigits)
+   {
+      string bitError = loadError([&]()
+      {
+         BitMaze bitMaze;
+         bitMaze.loadMaze(mazeFile);
+         bitMaze.checkMaze(mazeFile);
+      });
+      check(bitError == error, "bitplane stopped with \"" + bitError +
+            "\" and dfs with \"" + error + "\"");
+
+      string bigError = loadError([&]()
+      {
+         OutOfCoreMaze bigMaze(64);
+         bigMaze.loadMaze(mazeFile);
+         bigMaze.checkMaze();
+      });
+      check(bigError == error, "outofcore stopped with \"" + bigError +
+            "\" and dfs with \"" + error + "\"");
+   }
+
+   if (error.empty())
+   {
+      checkSolvers(maze, text, mazeFile, hasDigits);
+   }
+   else
+   {
+      checkMultiple(text, mazeFile);
+   }
+   return 0;
+}
+
+#ifdef FUZZ_STANDALONE
+
+/********************************************************\
+   without libFuzzer
+\********************************************************/
+
+string randomMaze()
+{
+   /*Small mazes that get through the checks often enough
+   to reach the solvers. Rows are ragged, the border is
+   left off some of the time and now and then there are
+   digits, extra starts and finishes, rows with no wall
+   or a character the loaders don't take. One in eight
+   is 60 to 200 cells wide, so rows run over more than
+   one 64 bit word and the word carries in jps, the
+   bit planes and the tiled layout get used.*/
+   static const char cells[] = "#  #   #  #123 ";
+   int width = (rand() % 8 == 0) ? 60 + rand() % 141 : 1 + rand() % 12;
+   int height = 1 + rand() % 12;
+   bool border = (rand() % 3 != 0);
+
+   vector<string> rows(height);
+   for (int y = 0; y < height; y++)
+   {
+      int length = width - ((rand() % 4 == 0) ? rand() % width : 0);
+      for (int x = 0; x < length; x++)
+      {
+         char c = cells[rand() % (sizeof(cells) - 1)];
+         if (border && (y == 0 || y == height - 1 || x == 0 || x == length - 1))
+         {
+            c = '#';
+         }
+         if (c >= '1' && c <= '9' && rand() % 4 != 0)
+         {
+            c = ' ';
+         }
+         rows[y] += c;
+      }
+      if (rand() % 20 == 0)
+      {
+         rows[y].assign(length, ' ');
+      }
+   }
+
+   int numStarts = (rand() % 8 == 0) ? rand() % 4 : 1;
+   int numFinishes = (rand() % 8 == 0) ? rand() % 4 : 1;
+   for (int i = 0; i < numStarts + numFinishes; i++)
+   {
+      string &row = rows[rand() % height];
+      if (!row.empty())
+      {
+         row[rand() % row.length()] = (i < numStarts) ? 's' : 'f';
+      }
+   }
+
+   string text;
+   for (int y = 0; y < height; y++)
+   {
+      text += rows[y];
+      if (y + 1 < height || rand() % 2 == 0)
+      {
+         text += '\n';
+      }
+   }
+   if (rand() % 50 == 0)
+   {
+      text[rand() % text.length()] = '@';
+   }
+   return text;
+}
+
+int main(int argc, char *argv[])
+{
+   long numRandom = 0;
+   int numFiles = 0;
+
+   for (int i = 1; i < argc; i++)
+   {
+      if (strcmp(argv[i], "-random") == 0 && i + 1 < argc)
+      {
+         numRandom = atol(argv[++i]);
+         continue;
+      }
+
+      string text;
+      try
+      {
+         Maze::readMazeFile(argv[i], text);
+      }
+      catch (const MazeError &error)
+      {
+         cout << error.what();
+         continue;
+      }
+      LLVMFuzzerTestOneInput((const uint8_t *)text.data(), text.size());
+      numFiles++;
+   }
+
+   srand(1);
+   for (long i = 0; i < numRandom; i++)
+   {
+      string text = randomMaze();
+      LLVMFuzzerTestOneInput((const uint8_t *)text.data(), text.size());
+   }
+
+   cout << "Checked " << numFiles << " files and " << numRandom << " random mazes\n";
+   return 0;
+}
+
+#endif
@@ -0,0 +1,112 @@
+#ifndef GRIDBFS_H
+#define GRIDBFS_H
+
+#include <algorithm>
+#include <vector>
+
+#include "mazegrid.h"
+
+/********************************************************\
+   breadth first search over a maze grid of any layout
+\********************************************************/
+
+template <typename GridType> class GridBfsSolver
+{
+   private:
+      // private data ====================================
+      const GridType &grid;
+
+      // direction each cell was reached by, -1 if not reached
+      // yet and 4 for the start. Kept in the grid's layout so
+      // it shares the locality of the cells themselves.
+      std::vector<signed char> cameFrom;
+
+      // bytes of the queue the last solve used
+      size_t queueBytes;
+
+   public:
+
+      /********************************************************\
+         constructor
+      \********************************************************/
+
+      GridBfsSolver(const GridType &mazeGrid) : grid(mazeGrid), queueBytes(0)
+      {
+      }
+
+      /********************************************************\
+         solve
+      \********************************************************/
+
+      bool solve(int startX, int startY, int finishX, int finishY,
+                 std::vector<GridPoint> &path)
+      {
+         /*Neighbours are tried down, up, right, left like
+         Maze::move, so ties between shortest paths are broken
+         the same way every time.
+         Returns false if the finish can not be reached.*/
+         static const int dirX[4] = { 0, 0, 1, -1 };
+         static const int dirY[4] = { 1, -1, 0, 0 };
+
+         path.clear();
+         queueBytes = 0;
+         if (!grid.isOpen(startX, startY)) return false;
+
+         cameFrom.assign(grid.storageSize(), -1);
+         cameFrom[grid.cellIndex(startX, startY)] = 4;
+
+         std::vector<GridPoint> queue;
+         queue.push_back(GridPoint(startX, startY));
+
+         bool found = false;
+         for (size_t head = 0; head < queue.size(); head++)
+         {
+            GridPoint p = queue[head];
+            if (p.x == finishX && p.y == finishY)
+            {
+               found = true;
+               break;
+            }
+
+            for (int d = 0; d < 4; d++)
+            {
+               int nx = p.x + dirX[d];
+               int ny = p.y + dirY[d];
+
+               if (!grid.isOpen(nx, ny)) continue;
+
+               size_t next = grid.cellIndex(nx, ny);
+               if (cameFrom[next] != -1) continue;
+
+               cameFrom[next] = d;
+               queue.push_back(GridPoint(nx, ny));
+            }
+         }
+
+         queueBytes = queue.capacity() * sizeof(GridPoint);
+         if (!found) return false;
+
+         // follow the directions back from the finish
+         GridPoint p(finishX, finishY);
+         int d = cameFrom[grid.cellIndex(p.x, p.y)];
+         while (d != 4)
+         {
+            path.push_back(p);
+            p.x -= dirX[d];
+            p.y -= dirY[d];
+            d = cameFrom[grid.cellIndex(p.x, p.y)];
+         }
+         path.push_back(p);
+
+         std::reverse(path.begin(), path.end());
+         return true;
+      }
+
+      size_t memoryUsed() const
+      {
+         // the directions and the queue of the last solve
+         return cameFrom.capacity() + queueBytes;
+      }
+};
+
+#endif
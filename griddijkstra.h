@@ -0,0 +1,131 @@
+#ifndef GRIDDIJKSTRA_H
+#define GRIDDIJKSTRA_H
+
+#include <stdint.h>
+#include <algorithm>
+#include <vector>
+
+#include "mazegrid.h"
+#include "radixheap.h"
+
+/********************************************************\
+   least cost path over a weighted maze grid
+
+   Stepping onto a cell costs its weight from cellCost,
+   1 to 9. Dijkstra's search with a radix heap, since
+   the costs are small integers that only ever grow.
+\********************************************************/
+
+template <typename GridType> class GridDijkstraSolver
+{
+   private:
+      // private data ====================================
+      const GridType &grid;
+
+      // least cost found so far to each cell and the direction
+      // it was reached by, -1 if not reached yet and 4 for the
+      // start. Kept in the grid's layout like GridBfsSolver.
+      std::vector<uint32_t> dist;
+      std::vector<signed char> cameFrom;
+
+      // bytes of the heap the last solve used
+      size_t heapBytes;
+
+   public:
+
+      /********************************************************\
+         constructor
+      \********************************************************/
+
+      GridDijkstraSolver(const GridType &mazeGrid) : grid(mazeGrid), heapBytes(0)
+      {
+      }
+
+      /********************************************************\
+         solve
+      \********************************************************/
+
+      bool solve(int startX, int startY, int finishX, int finishY,
+                 std::vector<GridPoint> &path)
+      {
+         /*Neighbours are tried down, up, right, left like
+         Maze::move. Returns false if the finish can not be
+         reached.*/
+         static const int dirX[4] = { 0, 0, 1, -1 };
+         static const int dirY[4] = { 1, -1, 0, 0 };
+
+         path.clear();
+         heapBytes = 0;
+         if (grid.cellCost(startX, startY) == 0) return false;
+
+         dist.assign(grid.storageSize(), UINT32_MAX);
+         cameFrom.assign(grid.storageSize(), -1);
+
+         size_t start = grid.cellIndex(startX, startY);
+         dist[start] = 0;
+         cameFrom[start] = 4;
+
+         radixHeap<GridPoint> openList;
+         openList.push(0, GridPoint(startX, startY));
+
+         bool found = false;
+         while (!openList.empty())
+         {
+            uint32_t cost;
+            GridPoint p;
+            openList.pop(cost, p);
+
+            // skip cells already settled at a lower cost
+            if (cost > dist[grid.cellIndex(p.x, p.y)]) continue;
+
+            if (p.x == finishX && p.y == finishY)
+            {
+               found = true;
+               break;
+            }
+
+            for (int d = 0; d < 4; d++)
+            {
+               int nx = p.x + dirX[d];
+               int ny = p.y + dirY[d];
+
+               int step = grid.cellCost(nx, ny);
+               if (step == 0) continue;
+
+               size_t next = grid.cellIndex(nx, ny);
+               if (cost + step < dist[next])
+               {
+                  dist[next] = cost + step;
+                  cameFrom[next] = d;
+                  openList.push(cost + step, GridPoint(nx, ny));
+               }
+            }
+         }
+
+         heapBytes = openList.memoryUsed();
+         if (!found) return false;
+
+         // follow the directions back from the finish
+         GridPoint p(finishX, finishY);
+         int d = cameFrom[grid.cellIndex(p.x, p.y)];
+         while (d != 4)
+         {
+            path.push_back(p);
+            p.x -= dirX[d];
+            p.y -= dirY[d];
+            d = cameFrom[grid.cellIndex(p.x, p.y)];
+         }
+         path.push_back(p);
+
+         std::reverse(path.begin(), path.end());
+         return true;
+      }
+
+      size_t memoryUsed() const
+      {
+         // the costs, the directions and the heap of the last solve
+         return dist.capacity() * sizeof(uint32_t) + cameFrom.capacity() + heapBytes;
+      }
+};
+
+#endif
@@ -0,0 +1,151 @@
+#ifndef GRIDMULTI_H
+#define GRIDMULTI_H
+
+#include <stdint.h>
+#include <vector>
+
+#include "mazegrid.h"
+
+/********************************************************\
+   nearest finish from every start in one search
+
+   A breadth first search is started from all the
+   finishes at once, so the first finish to reach a cell
+   is its nearest one. Every start then knows its nearest
+   finish and how far it is, and the path is found by
+   following the directions back to that finish.
+\********************************************************/
+
+template <typename GridType> class GridMultiSolver
+{
+   private:
+      // private data ====================================
+      const GridType &grid;
+
+      // steps from the nearest finish and which finish that is,
+      // kept in the grid's layout like GridBfsSolver
+      std::vector<uint32_t> dist;
+      std::vector<int> nearest;
+
+      // direction back towards the nearest finish, -1 if the
+      // cell wasn't reached and 4 on a finish
+      std::vector<signed char> toFinish;
+
+      // bytes of the queue the last solve used
+      size_t queueBytes;
+
+   public:
+
+      /********************************************************\
+         constructor
+      \********************************************************/
+
+      GridMultiSolver(const GridType &mazeGrid) : grid(mazeGrid), queueBytes(0)
+      {
+      }
+
+      /********************************************************\
+         solve
+      \********************************************************/
+
+      void solve(const std::vector<GridPoint> &finishes,
+                 const std::vector<GridPoint> &starts)
+      {
+         /*Searches out from every finish at once until all the
+         starts have been reached or nothing is left to reach.
+         Neighbours are tried down, up, right, left.*/
+         static const int dirX[4] = { 0, 0, 1, -1 };
+         static const int dirY[4] = { 1, -1, 0, 0 };
+
+         dist.assign(grid.storageSize(), UINT32_MAX);
+         nearest.assign(grid.storageSize(), -1);
+         toFinish.assign(grid.storageSize(), -1);
+
+         std::vector<GridPoint> queue;
+         for (unsigned int i = 0; i < finishes.size(); i++)
+         {
+            size_t cell = grid.cellIndex(finishes[i].x, finishes[i].y);
+            dist[cell] = 0;
+            nearest[cell] = i;
+            toFinish[cell] = 4;
+            queue.push_back(finishes[i]);
+         }
+
+         // a start on the far side of a wall from every finish
+         // is never reached so the count may not get to zero
+         unsigned int startsLeft = starts.size();
+
+         for (size_t head = 0; head < queue.size() && startsLeft > 0; head++)
+         {
+            GridPoint p = queue[head];
+            size_t cell = grid.cellIndex(p.x, p.y);
+            if (grid.getCell(p.x, p.y) == 's') startsLeft--;
+
+            for (int d = 0; d < 4; d++)
+            {
+               int nx = p.x + dirX[d];
+               int ny = p.y + dirY[d];
+
+               if (!grid.isOpen(nx, ny)) continue;
+
+               size_t next = grid.cellIndex(nx, ny);
+               if (toFinish[next] != -1) continue;
+
+               // the way back is the opposite of the way here
+               dist[next] = dist[cell] + 1;
+               nearest[next] = nearest[cell];
+               toFinish[next] = d ^ 1;
+               queue.push_back(GridPoint(nx, ny));
+            }
+         }
+         queueBytes = queue.capacity() * sizeof(GridPoint);
+      }
+
+      /********************************************************\
+         results
+      \********************************************************/
+
+      bool reached(const GridPoint &start) const
+      {
+         return (toFinish[grid.cellIndex(start.x, start.y)] != -1);
+      }
+
+      int distance(const GridPoint &start) const
+      {
+         return dist[grid.cellIndex(start.x, start.y)];
+      }
+
+      int nearestFinish(const GridPoint &start) const
+      {
+         // index into the finishes given to solve
+         return nearest[grid.cellIndex(start.x, start.y)];
+      }
+
+      void pathFrom(const GridPoint &start, std::vector<GridPoint> &path) const
+      {
+         // path from a reached start to its nearest finish
+         static const int dirX[4] = { 0, 0, 1, -1 };
+         static const int dirY[4] = { 1, -1, 0, 0 };
+
+         path.clear();
+         GridPoint p = start;
+         int d = toFinish[grid.cellIndex(p.x, p.y)];
+         while (d != 4)
+         {
+            path.push_back(p);
+            p.x += dirX[d];
+            p.y += dirY[d];
+            d = toFinish[grid.cellIndex(p.x, p.y)];
+         }
+         path.push_back(p);
+      }
+
+      size_t memoryUsed() const
+      {
+         // the three per cell arrays and the queue of the last solve
+         return dist.capacity() * sizeof(uint32_t) + nearest.capacity() * sizeof(int) +
+                toFinish.capacity() + queueBytes;
+      }
+};
+
+#endif
@@ -0,0 +1,426 @@
+#ifndef JUMPPOINT_H
+#define JUMPPOINT_H
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <queue>
+#include <unordered_map>
+#include <vector>
+
+#include "mazegrid.h"
+
+/********************************************************\
+   jump point search for a 4-connected maze grid
+
+   Only jump points are pushed onto the open list. A
+   jump point is the goal, or a cell where a side cell
+   opens up behind a wall (a forced neighbour), so long
+   runs through open rooms are crossed in one step.
+   Each row keeps bit masks of open cells and of the
+   cells a horizontal scan has to stop at, so scanning
+   along a row tests 64 cells per word. A third mask
+   holds the cells a horizontal scan would find a jump
+   point from, so a vertical scan tests one bit a step.
+   Search state is only kept for the jump points, in a
+   hash map, so nothing per cell is allocated for it.
+\********************************************************/
+
+class JumpPointSolver
+{
+   private:
+      // private data ====================================
+      const MazeGrid &grid;
+      int width, height, words;
+
+      // one bit per cell, words per row
+      std::vector<uint64_t> openBits;
+
+      // cells a scan moving right or left stops at: walls,
+      // cells past the row end and cells with a forced neighbour
+      std::vector<uint64_t> stopRight, stopLeft;
+
+      // cells where a scan right or left finds a forced
+      // neighbour before a wall, a vertical scan stops on them
+      std::vector<uint64_t> turnBits;
+
+      int goalX, goalY;
+
+      // bytes of the node table and open list the last solve used
+      size_t searchBytes;
+
+      // states are cell * 5 + direction of arrival, 4 means none
+      struct JumpNode
+      {
+         int g;
+         size_t parent;
+      };
+
+      static const size_t noParent = (size_t)-1;
+
+      struct OpenNode
+      {
+         int f, g;
+         size_t state;
+
+         bool operator < (const OpenNode &other) const
+         {
+            // priority_queue pops the largest, so order by lowest
+            // f first and break ties on the deepest node
+            if (f != other.f) return f > other.f;
+            return g < other.g;
+         }
+      };
+
+      // private functions ===============================
+
+      bool open(int x, int y) const
+      {
+         if (!grid.inside(x, y)) return false;
+         return (openBits[(size_t)y * words + (x >> 6)] >> (x & 63)) & 1;
+      }
+
+      static int lowestBit(uint64_t bits)
+      {
+         return __builtin_ctzll(bits);
+      }
+
+      static int highestBit(uint64_t bits)
+      {
+         return 63 - __builtin_clzll(bits);
+      }
+
+      int nextStop(int y, int from) const
+      {
+         // first stop bit at or after from, every row has padding
+         // bits past the end so one is always found
+         const uint64_t *row = &stopRight[(size_t)y * words];
+         int w = from >> 6;
+         uint64_t bits = row[w] & (~0ULL << (from & 63));
+
+         while (bits == 0)
+         {
+            w++;
+            bits = row[w];
+         }
+         return (w << 6) + lowestBit(bits);
+      }
+
+      int prevStop(int y, int from) const
+      {
+         // last stop bit at or before from, -1 if there is none
+         if (from < 0) return -1;
+
+         const uint64_t *row = &stopLeft[(size_t)y * words];
+         int w = from >> 6;
+         uint64_t bits = row[w] & (~0ULL >> (63 - (from & 63)));
+
+         while (bits == 0)
+         {
+            if (w == 0) return -1;
+            w--;
+            bits = row[w];
+         }
+         return (w << 6) + highestBit(bits);
+      }
+
+      bool testBit(const std::vector<uint64_t> &bits, int x, int y) const
+      {
+         return (bits[(size_t)y * words + (x >> 6)] >> (x & 63)) & 1;
+      }
+
+      static uint64_t bitRange(int lo, int hi)
+      {
+         // bits lo to hi, none if hi is below lo
+         if (hi < lo) return 0;
+         return (~0ULL >> (63 - hi)) & (~0ULL << lo);
+      }
+
+      void buildTurns(int y)
+      {
+         /*A scan right from x finds a jump point when the first
+         stop after x is open. That is the same for every cell
+         between two stops, so each word is filled a run at a
+         time between its stop bits, the way the scans jump.*/
+         const uint64_t *row = &openBits[(size_t)y * words];
+         const uint64_t *right = &stopRight[(size_t)y * words];
+         const uint64_t *left = &stopLeft[(size_t)y * words];
+         uint64_t *turns = &turnBits[(size_t)y * words];
+
+         bool stopOpen = false;
+         for (int w = words - 1; w >= 0; w--)
+         {
+            uint64_t stops = right[w];
+            int top = 64;
+            while (stops != 0)
+            {
+               int b = highestBit(stops);
+               if (stopOpen) turns[w] |= bitRange(b, top - 1);
+               stopOpen = (row[w] >> b) & 1;
+               stops &= ~(1ULL << b);
+               top = b;
+            }
+            if (stopOpen) turns[w] |= bitRange(0, top - 1);
+         }
+
+         stopOpen = false;
+         for (int w = 0; w < words; w++)
+         {
+            uint64_t stops = left[w];
+            int bottom = 0;
+            while (stops != 0)
+            {
+               int b = lowestBit(stops);
+               if (stopOpen) turns[w] |= bitRange(bottom, b);
+               stopOpen = (row[w] >> b) & 1;
+               stops &= stops - 1;
+               bottom = b + 1;
+            }
+            if (stopOpen) turns[w] |= bitRange(bottom, 63);
+         }
+      }
+
+      void buildMasks()
+      {
+         openBits.assign((size_t)height * words, 0);
+         stopRight.assign((size_t)height * words, 0);
+         stopLeft.assign((size_t)height * words, 0);
+         turnBits.assign((size_t)height * words, 0);
+
+         for (int y = 0; y < height; y++)
+         {
+            for (int x = 0; x < grid.rowLength(y); x++)
+            {
+               if (grid.isOpen(x, y))
+               {
+                  openBits[(size_t)y * words + (x >> 6)] |= 1ULL << (x & 63);
+               }
+            }
+         }
+
+         std::vector<uint64_t> noRow(words, 0);
+         for (int y = 0; y < height; y++)
+         {
+            const uint64_t *row = &openBits[(size_t)y * words];
+            const uint64_t *above = (y > 0) ?
+               &openBits[(size_t)(y - 1) * words] : &noRow[0];
+            const uint64_t *below = (y + 1 < height) ?
+               &openBits[(size_t)(y + 1) * words] : &noRow[0];
+
+            for (int w = 0; w < words; w++)
+            {
+               // a side cell is forced when it is open but the side
+               // cell the scan has just passed is not
+               uint64_t aPrev = (above[w] << 1) | (w > 0 ? above[w - 1] >> 63 : 0);
+               uint64_t bPrev = (below[w] << 1) | (w > 0 ? below[w - 1] >> 63 : 0);
+               uint64_t aNext = (above[w] >> 1) | (w + 1 < words ? above[w + 1] << 63 : 0);
+               uint64_t bNext = (below[w] >> 1) | (w + 1 < words ? below[w + 1] << 63 : 0);
+
+               uint64_t forcedRight = (above[w] & ~aPrev) | (below[w] & ~bPrev);
+               uint64_t forcedLeft = (above[w] & ~aNext) | (below[w] & ~bNext);
+
+               stopRight[(size_t)y * words + w] = ~row[w] | forcedRight;
+               stopLeft[(size_t)y * words + w] = ~row[w] | forcedLeft;
+            }
+            buildTurns(y);
+         }
+      }
+
+      size_t stateOf(int x, int y, int arrived) const
+      {
+         // size_t so mazes past 2^31 / 5 cells still fit
+         return ((size_t)y * width + x) * 5 + arrived;
+      }
+
+      int jumpHorizontal(int x, int y, int dx) const
+      {
+         // scan along row y from x, returns the column of the next
+         // jump point or -1 if the scan runs into a wall
+         int stop;
+
+         if (dx > 0)
+         {
+            stop = nextStop(y, x + 1);
+            if (y == goalY && goalX > x && goalX <= stop) return goalX;
+         }
+         else
+         {
+            stop = prevStop(y, x - 1);
+            if (y == goalY && goalX < x && goalX >= stop) return goalX;
+         }
+
+         if (!open(stop, y)) return -1;
+         return stop;
+      }
+
+      int jumpVertical(int x, int y, int dy) const
+      {
+         // step along column x from y, a cell is a jump point when
+         // a scan across its row finds one, which only needs its
+         // turn bit unless the goal is on that row
+         while (true)
+         {
+            y += dy;
+            if (!open(x, y)) return -1;
+
+            if (testBit(turnBits, x, y)) return y;
+
+            if (y == goalY && (x == goalX || jumpHorizontal(x, y, 1) >= 0 ||
+                  jumpHorizontal(x, y, -1) >= 0))
+            {
+               return y;
+            }
+         }
+      }
+
+   public:
+
+      /********************************************************\
+         constructor
+      \********************************************************/
+
+      JumpPointSolver(const MazeGrid &mazeGrid) : grid(mazeGrid)
+      {
+         width = grid.getWidth();
+         height = grid.getHeight();
+
+         // always at least one padding bit past the end of a row
+         words = (width >> 6) + 1;
+         goalX = goalY = -1;
+         searchBytes = 0;
+
+         buildMasks();
+      }
+
+      /********************************************************\
+         solve
+      \********************************************************/
+
+      bool solve(int startX, int startY, int finishX, int finishY,
+                 std::vector<GridPoint> &path)
+      {
+         /*A* over jump points with a manhattan distance heuristic.
+         Moves are tried down, up, right, left like Maze::move.
+         A node keeps going the way it arrived or turns to the
+         side, it never turns back. The start tries all four.
+         Returns false if the finish can not be reached.*/
+         static const int dirX[4] = { 0, 0, 1, -1 };
+         static const int dirY[4] = { 1, -1, 0, 0 };
+
+         path.clear();
+         searchBytes = 0;
+         if (!open(startX, startY) || !open(finishX, finishY)) return false;
+
+         goalX = finishX;
+         goalY = finishY;
+
+         std::unordered_map<size_t, JumpNode> jumpNodes;
+         jumpNodes.reserve(1 << 12);
+         std::priority_queue<OpenNode> openList;
+
+         OpenNode first;
+         first.g = 0;
+         first.f = abs(finishX - startX) + abs(finishY - startY);
+         first.state = stateOf(startX, startY, 4);
+         JumpNode startNode = { 0, noParent };
+         jumpNodes[first.state] = startNode;
+         openList.push(first);
+         size_t mostOpen = 1;
+
+         size_t goalState = noParent;
+         while (!openList.empty())
+         {
+            OpenNode node = openList.top();
+            openList.pop();
+
+            if (node.g > jumpNodes[node.state].g) continue;
+
+            size_t cell = node.state / 5;
+            int arrived = node.state % 5;
+            int x = cell % width;
+            int y = cell / width;
+
+            if (x == goalX && y == goalY)
+            {
+               goalState = node.state;
+               break;
+            }
+
+            for (int d = 0; d < 4; d++)
+            {
+               if (arrived != 4 && d != arrived)
+               {
+                  // only turn to the side of the way we arrived
+                  bool arrivedVertical = (arrived < 2);
+                  bool turnVertical = (d < 2);
+                  if (arrivedVertical == turnVertical) continue;
+               }
+
+               int nx = x, ny = y;
+               if (dirX[d] != 0)
+               {
+                  nx = jumpHorizontal(x, y, dirX[d]);
+                  if (nx < 0) continue;
+               }
+               else
+               {
+                  ny = jumpVertical(x, y, dirY[d]);
+                  if (ny < 0) continue;
+               }
+
+               OpenNode next;
+               next.g = node.g + abs(nx - x) + abs(ny - y);
+               next.state = stateOf(nx, ny, d);
+
+               std::unordered_map<size_t, JumpNode>::iterator seen =
+                  jumpNodes.find(next.state);
+               if (seen == jumpNodes.end() || next.g < seen->second.g)
+               {
+                  JumpNode reached = { next.g, node.state };
+                  jumpNodes[next.state] = reached;
+                  next.f = next.g + abs(finishX - nx) + abs(finishY - ny);
+                  openList.push(next);
+                  if (openList.size() > mostOpen) mostOpen = openList.size();
+               }
+            }
+         }
+
+         // each table entry is a node of its own with a next pointer
+         searchBytes = jumpNodes.bucket_count() * sizeof(void *) +
+            jumpNodes.size() * (sizeof(std::pair<const size_t, JumpNode>) + sizeof(void *)) +
+            mostOpen * sizeof(OpenNode);
+         if (goalState == noParent) return false;
+
+         // walk back over the jump points filling in each straight run
+         std::vector<GridPoint> jumps;
+         for (size_t s = goalState; s != noParent; s = jumpNodes[s].parent)
+         {
+            jumps.push_back(GridPoint((s / 5) % width, (s / 5) / width));
+         }
+
+         path.push_back(jumps.back());
+         for (int i = (int)jumps.size() - 1; i > 0; i--)
+         {
+            GridPoint from = jumps[i];
+            GridPoint to = jumps[i - 1];
+            int stepX = (to.x > from.x) - (to.x < from.x);
+            int stepY = (to.y > from.y) - (to.y < from.y);
+
+            while (from.x != to.x || from.y != to.y)
+            {
+               from.x += stepX;
+               from.y += stepY;
+               path.push_back(from);
+            }
+         }
+         return true;
+      }
+
+      size_t memoryUsed() const
+      {
+         // the bit planes and the search state of the last solve
+         return (openBits.capacity() + stopRight.capacity() + stopLeft.capacity() +
+                 turnBits.capacity()) * sizeof(uint64_t) + searchBytes;
+      }
+};
+
+#endif
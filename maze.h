@@ -0,0 +1,849 @@
+#ifndef MAZE_H
+#define MAZE_H
+
+#include <algorithm>
+#include <iostream>
+#include <fstream>
+#include <string.h>
+#include <string>
+#include <vector>
+#include <iterator>
+#include <thread>
+
+#include "bintree.h"
+#include "mazeerror.h"
+#include "memstats.h"
+#include "rowscan.h"
+#include "tracebuffer.h"
+
+/********************************************************\
+   the tree based maze
+
+   Each row of the maze is a tree of points keyed on x
+   and the rows are a frozen tree keyed on y. Maze loads,
+   checks and solves it with the original recursive depth
+   first search, MazeSolveTask runs the same search a few
+   moves at a time. Loading or checking a bad maze throws
+   MazeError.
+\********************************************************/
+
+class MazePoint
+{
+   private:
+   char value;
+   int x;
+
+   public:
+      
+   MazePoint()
+   {
+      value = ' ';
+      x = 0;
+   }
+
+   MazePoint(int i)
+   {
+      value = ' ';
+      x = i;
+   }
+
+   char getValue() const
+   {
+      return value;
+   }
+      
+   void setValue(char c)
+   {
+      value = c;
+   }
+
+   int getX() const
+   {
+      return x;
+   }
+
+   //overloaded operators
+
+   bool operator < (const MazePoint &other) const
+   {
+      return x < other.x;
+   }
+
+   bool operator == (const MazePoint &other) const
+   {
+      return x == other.x;
+   }
+
+   //let the trees look a point up by its x alone
+
+   friend bool operator < (int key, const MazePoint &point)
+   {
+      return key < point.x;
+   }
+
+   friend bool operator == (int key, const MazePoint &point)
+   {
+      return key == point.x;
+   }
+};
+
+class MazeRow
+{
+   private:
+   bintree<MazePoint> mazePoints;
+   int y;
+
+   //x of the first and last '#' in the row, -1 if there are none
+   int firstWall, lastWall;
+
+   public:
+
+   MazeRow()
+   {
+      y = 0;
+      firstWall = -1;
+      lastWall = -1;
+   }
+      
+   MazeRow(int i)
+   {
+      y = i;
+      firstWall = -1;
+      lastWall = -1;
+   }
+
+   //rows own a whole tree of points so they are moved, not copied,
+   //whenever they can be
+   MazeRow(const MazeRow &other) = default;
+   MazeRow(MazeRow &&other) noexcept = default;
+   MazeRow& operator = (const MazeRow &other) = default;
+   MazeRow& operator = (MazeRow &&other) noexcept = default;
+
+   int getY() const
+   {
+      return y;
+   }
+   
+   int rowLength() const
+   {
+      return mazePoints.size();
+   }
+
+   size_t memoryUsed() const
+   {
+      //the nodes of the point tree, the row itself is counted
+      //by the tree of rows
+      return mazePoints.memoryUsed();
+   }
+
+   bool outsideWalls(int x) const
+   {
+      //outside if left of the first wall, right of the last
+      //wall or the row has no walls at all
+      return (firstWall < 0 || x < firstWall || x > lastWall);
+   }
+
+   //walk the MazePoints of the row in x order
+   bintree<MazePoint>::iterator begin()
+   {
+      return mazePoints.begin();
+   }
+
+   bintree<MazePoint>::iterator end()
+   {
+      return mazePoints.end();
+   }
+
+   bintree<MazePoint>::const_iterator begin() const
+   {
+      return mazePoints.begin();
+   }
+
+   bintree<MazePoint>::const_iterator end() const
+   {
+      return mazePoints.end();
+   }
+
+   std::string toString() const
+   {
+      //prints out each MazePoint in this MazeRow
+      std::string line;
+      line.reserve(mazePoints.size());
+
+      for (const MazePoint &mPoint : mazePoints)
+      {
+         line += mPoint.getValue();
+      }
+      return line;
+   }
+
+   char searchMazePoint(int x) const
+   {
+      /*Used for searching for a specific MazePoint
+      using its x coordinate.*/
+      char c = '\0';
+
+      const MazePoint *mPoint = mazePoints.findConst(x);
+      if (mPoint != NULL)
+      {
+         c = mPoint->getValue();
+      }
+
+      return c;
+   }
+   
+   void changeMazePoint(const int x, const char &c)
+   {
+      /*Used to mark the maze with breadcrumbs
+      and the actual path.*/
+      MazePoint *mPoint = mazePoints.find(x);
+      if (mPoint != NULL)
+      {
+         char sc = mPoint->getValue();
+
+         //x doesn't change so the point keeps its place
+         if (sc != 's')
+         {
+            mPoint->setValue(c);
+         }
+      }
+   }
+   
+   bool insertMazePointsIntoRow(const char *line, int length)
+   {
+      /*Will only insert a char into the MazeRow
+      if it is a '#', ' ', 's', 'f', '\n' or a digit
+      1 to 9 for a cell that costs that much to cross.
+      Otherwise it returns false and the row is left empty,
+      rows are loaded on several threads so the caller
+      reports the error.*/
+      findWalls(line, length, firstWall, lastWall);
+
+      std::vector<MazePoint> points;
+      points.reserve(length);
+
+      for(int i = 0; i < length; i++)
+      {
+         if (line[i] == '#' || line[i] == ' ' || line[i] == 's' || 
+                  line[i] == 'f' || line[i] == '\n' ||
+                  (line[i] >= '1' && line[i] <= '9'))
+         {
+            MazePoint mazePoint(i);
+            mazePoint.setValue(line[i]);
+            points.push_back(mazePoint);
+         } 
+         else
+         {
+            return false;
+         }
+      }
+
+      //x is already in order so the row can be built in one go
+      mazePoints.buildFromSorted(points.begin(), points.end());
+      return true;
+   }
+
+   //overloaded operators
+
+   bool operator < (const MazeRow &other) const
+   {
+      return y < other.y;
+   }
+
+   bool operator == (const MazeRow &other) const
+   {
+      return y == other.y;
+   }
+
+   //let the trees look a row up by its y alone, so no
+   //empty row has to be built for each search
+
+   friend bool operator < (int key, const MazeRow &row)
+   {
+      return key < row.y;
+   }
+
+   friend bool operator == (int key, const MazeRow &row)
+   {
+      return key == row.y;
+   }
+};
+
+class Maze
+{
+   //steps through the same search as move a little at a time
+   friend class MazeSolveTask;
+
+   private:
+   //rows never change shape once loaded so they are kept frozen
+   frozenTree<MazeRow> mazeRows;
+   int startX, startY, finishX, finishY;
+
+   //a piece of the file made of whole lines, parsed by one thread
+   struct RowChunk
+   {
+      size_t begin, end;
+      int firstRow, numRows;
+
+      //the first row of the chunk with a character the maze
+      //doesn't take, -1 if there is none
+      int badRow;
+   };
+
+   //files smaller than this per thread aren't worth splitting
+   static const size_t minChunkBytes = 1 << 20;
+
+   static void countRows(const std::string &text, RowChunk &chunk)
+   {
+      //every line ends in a newline except maybe the last one
+      //in the file, same as getline
+      chunk.numRows = 0;
+      const char *p = text.data() + chunk.begin;
+      const char *end = text.data() + chunk.end;
+
+      while (p < end)
+      {
+         const char *newline = (const char *)memchr(p, '\n', end - p);
+         chunk.numRows++;
+         if (newline == NULL) break;
+         p = newline + 1;
+      }
+   }
+
+   static void parseRows(const std::string &text, RowChunk &chunk, 
+                         std::vector<MazeRow> &rows)
+   {
+      //each chunk fills its own rows so no locking is needed,
+      //the first bad row stops the chunk
+      const char *p = text.data() + chunk.begin;
+      const char *end = text.data() + chunk.end;
+
+      for (int i = 0; i < chunk.numRows; i++)
+      {
+         const char *newline = (const char *)memchr(p, '\n', end - p);
+         const char *lineEnd = (newline == NULL) ? end : newline;
+
+         MazeRow &mRow = rows[chunk.firstRow + i];
+         mRow = MazeRow(chunk.firstRow + i);
+         if (!mRow.insertMazePointsIntoRow(p, lineEnd - p))
+         {
+            chunk.badRow = chunk.firstRow + i;
+            return;
+         }
+         p = lineEnd + 1;
+      }
+   }
+
+   public:
+
+   void loadMaze(const char *filename, int numThreads)
+   {
+      /*The whole file is read in one go and its rows
+      are parsed on up to numThreads threads*/
+      std::string text;
+      readMazeFile(filename, text);
+      insertRowsIntoTree(text, numThreads);
+   }
+
+   static void readMazeFile(const char *filename, std::string &text)
+   {
+      //the raw bytes of a maze file
+      std::ifstream fin;
+
+      fin.open(filename, std::ios::binary);
+      if (!fin)
+      {
+         throw MazeError(std::string("Unable to load maze ") + filename + "\n");
+      }
+
+      text.clear();
+      fin.seekg(0, std::ios::end);
+      std::streamoff fileSize = fin.tellg();
+      fin.seekg(0, std::ios::beg);
+      if (fileSize > 0)
+      {
+         text.reserve(fileSize);
+      }
+
+      char block[1 << 16];
+      while (fin.read(block, sizeof(block)) || fin.gcount() > 0)
+      {
+         text.append(block, fin.gcount());
+      }
+   }
+
+   void insertRowsIntoTree(const std::string &text, int numThreads,
+                           size_t chunkBytes = minChunkBytes)
+   {
+      /*The text is split into chunks of whole lines, one
+      per thread, with at least chunkBytes in each. fuzzmaze
+      passes a few bytes so small mazes are split too. The threads count their lines so each
+      knows which row number it starts at, then parse
+      their rows straight into their own part of rows.
+      Rows are numbered in order so they are then moved 
+      into the tree in one go and frozen for the lookups
+      in move.*/
+      size_t numChunks = text.size() / std::max(chunkBytes, (size_t)1) + 1;
+      if (numThreads < 1)
+      {
+         numThreads = 1;
+      }
+      if (numChunks > (size_t)numThreads)
+      {
+         numChunks = numThreads;
+      }
+
+      std::vector<RowChunk> chunks(numChunks);
+      size_t begin = 0;
+      for (size_t c = 0; c < numChunks; c++)
+      {
+         //move each split point on to the start of the next line
+         size_t end = text.size() * (c + 1) / numChunks;
+         if (end < begin)
+         {
+            end = begin;
+         }
+         while (end < text.size() && end > 0 && text[end - 1] != '\n')
+         {
+            end++;
+         }
+
+         chunks[c].begin = begin;
+         chunks[c].end = end;
+         chunks[c].badRow = -1;
+         begin = end;
+      }
+
+      runOnThreads(chunks, [&text](RowChunk &chunk) 
+      {
+         countRows(text, chunk);
+      });
+
+      int numRows = 0;
+      for (RowChunk &chunk : chunks)
+      {
+         chunk.firstRow = numRows;
+         numRows += chunk.numRows;
+      }
+
+      std::vector<MazeRow> rows(numRows);
+      runOnThreads(chunks, [&text, &rows](RowChunk &chunk) 
+      {
+         parseRows(text, chunk, rows);
+      });
+
+      //chunks are in file order, so the first chunk with a bad
+      //row has the first bad row in the file
+      for (const RowChunk &chunk : chunks)
+      {
+         if (chunk.badRow >= 0)
+         {
+            throw MazeError::invalidCharacter(chunk.badRow);
+         }
+      }
+
+      bintree<MazeRow> rowTree;
+      rowTree.buildFromSorted(std::make_move_iterator(rows.begin()), 
+                              std::make_move_iterator(rows.end()));
+      mazeRows = rowTree.freeze();
+   }
+
+   template <typename workType>
+   static void runOnThreads(std::vector<RowChunk> &chunks, workType work)
+   {
+      //one thread per chunk, the first chunk is done on this one
+      std::vector<std::thread> threads;
+
+      for (size_t c = 1; c < chunks.size(); c++)
+      {
+         threads.emplace_back(work, std::ref(chunks[c]));
+      }
+      work(chunks[0]);
+
+      for (std::thread &t : threads)
+      {
+         t.join();
+      }
+   }
+   
+   void checkMaze(const char *mazeFile, bool allowMany = false)
+   {
+      /*Check the maze
+      Number of start and finish should be equal to 1,
+      or at least 1 if allowMany is set
+      Also checks if the start and finish points 
+      are located outside of the maze
+      
+      The (x,y) coordinates of the starting point
+      is saved for finding the path later*/
+      int numStart = 0 , numFinish = 0;
+      bool startOutside = false, finishOutside = false;
+      startX = startY = finishX = finishY = 0;
+
+      for (const MazeRow &mRow : mazeRows)
+      {
+         for (const MazePoint &mPoint : mRow)
+         {
+            char c = mPoint.getValue();
+
+            if (c == 's')
+            {
+               numStart++;
+
+               startX = mPoint.getX();
+               startY = mRow.getY();
+
+               if (allowMany && ifOutside('s', startX, startY) == true)
+               {
+                  startOutside = true;
+               }
+            }
+
+            if (c == 'f')
+            {
+               numFinish++;
+
+               finishX = mPoint.getX();
+               finishY = mRow.getY();
+
+               if (allowMany && ifOutside('f', finishX, finishY) == true)
+               {
+                  finishOutside = true;
+               }
+            }
+         }
+      }
+      
+      if (!allowMany)
+      {
+         startOutside = (numStart > 0 && ifOutside('s', startX, startY));
+         finishOutside = (numFinish > 0 && ifOutside('f', finishX, finishY));
+      }
+      
+      if (startOutside)
+      {
+         throw MazeError(std::string("Error - start declared outside of maze\n") +
+                         "Unable to load maze " + mazeFile + "\n");
+      }
+      if (finishOutside)
+      {
+         throw MazeError(std::string("Error - finish declared outside of maze\n") +
+                         "Unable to load maze " + mazeFile + "\n");
+      }
+      checkStart(numStart, allowMany);
+      checkFinish(numFinish, allowMany);
+   }
+   
+   void checkStart(int i, bool allowMany)
+   {
+      if (i == 0)
+      {
+         throw MazeError("Error - no start found in maze\n");
+      }
+
+      if (i > 1 && !allowMany)
+      {
+         throw MazeError("Error - multiple start found in maze\n");
+      }
+   }
+   
+   void checkFinish(int i, bool allowMany)
+   {
+      if (i == 0)
+      {
+         throw MazeError("Error - no finish found in maze\n");
+      }
+
+      if (i >1 && !allowMany)
+      {
+         throw MazeError("Error - multiple finish found in maze\n");
+      }
+   }
+   
+   bool ifOutside(const char c, int x, int y)
+   {
+      /*A character is outside if there is no hash
+      on its side of it in its row, on the left or
+      the right, or the row has no hash at all.
+      The walls of each row are found when it is
+      loaded so this is one row lookup.
+      
+      Assumes the maze is not U-shaped*/
+      const MazeRow *mRow = mazeRows.findConst(y);
+      if (mRow != NULL)
+      {
+         return mRow->outsideWalls(x);
+      }
+
+      return false;
+   }
+   
+   void findPathThroughMaze()
+   {
+      //Give the starting point to the move function
+      NullTracer tracer;
+      move(startX, startY, tracer);
+   }
+
+   template <typename Tracer> void findPathThroughMaze(Tracer &tracer)
+   {
+      //Same search with every move recorded by tracer
+      move(startX, startY, tracer);
+   }
+   
+   template <typename Tracer> bool move(int x, int y, Tracer &tracer)
+   {
+      /*Check if on finishing point
+      If yes, return true all the way up the stack
+      Clean the maze up and change the path from spaces to a '.'
+      If not, move down, up, right, left and leave breadcrumb
+      The tracer hears of each breadcrumb, dead end and path
+      cell, NullTracer compiles to nothing*/
+      if (x < 0 || y < 0)
+      {
+         return false;
+      }
+
+      MazeRow *mRow = mazeRows.find(y);
+
+      if (mRow != NULL)
+      {
+         char c = mRow->searchMazePoint(x);
+
+         if (c == 'f')
+         {
+            return true;
+         }
+
+         if (c == ' ' || c == 's')
+         {
+            mRow->changeMazePoint(x, '!');
+            tracer.enter(x, y);
+
+            if (move(x, y+1, tracer) == true)
+            {
+               cleanUpMaze();
+               mRow->changeMazePoint(x, '.');
+               tracer.path(x, y);
+               return true;
+            }
+            if (move(x, y-1, tracer) == true)
+            {
+               cleanUpMaze();
+               mRow->changeMazePoint(x, '.');
+               tracer.path(x, y);
+               return true;
+            }
+            if (move(x+1, y, tracer) == true)
+            {
+               cleanUpMaze();
+               mRow->changeMazePoint(x, '.');
+               tracer.path(x, y);
+               return true;
+            }
+            if (move(x-1, y, tracer) == true)
+            {
+               cleanUpMaze();
+               mRow->changeMazePoint(x, '.');
+               tracer.path(x, y);
+               return true;
+            }
+            tracer.backtrack(x, y);
+         }
+      }
+      return false;
+   }
+   
+   void cleanUpMaze()
+   {
+      //only the value changes so the points can be
+      //updated where they sit in the tree
+      for (MazeRow &mRow : mazeRows)
+      {
+         for (MazePoint &mPoint : mRow)
+         {
+            if (mPoint.getValue() == '!')
+            {
+               mPoint.setValue(' ');
+            }
+         }
+      }
+   }
+   
+   void printMaze() const
+   {
+      mazeRows.print();
+   }
+
+   void reportMemory(MemoryReport &report) const
+   {
+      //every character of the maze is a point in a row's tree
+      size_t numCells = 0, pointBytes = 0;
+
+      for (const MazeRow &mRow : mazeRows)
+      {
+         numCells += mRow.rowLength();
+         pointBytes += mRow.memoryUsed();
+      }
+
+      report.setCells(numCells);
+      report.add("rows", mazeRows.memoryUsed());
+      report.add("points", pointBytes);
+   }
+
+   template <typename GridType> void copyToGrid(GridType &grid) const
+   {
+      //Copy the maze into a flat grid for the grid based solvers
+      int width = 0;
+
+      for (const MazeRow &mRow : mazeRows)
+      {
+         if (mRow.rowLength() > width)
+         {
+            width = mRow.rowLength();
+         }
+      }
+
+      grid.resize(width, mazeRows.size());
+
+      for (const MazeRow &mRow : mazeRows)
+      {
+         grid.setRow(mRow.getY(), mRow.toString());
+      }
+   }
+};
+
+class MazeSolveTask
+{
+   /*The search move does, as a state machine that can be
+   run a few steps at a time. The recursion of move is
+   kept on an explicit stack, each entry is a cell and the
+   next direction it will try, so step can stop after any
+   number of moves and carry on where it left off. The
+   maze ends up marked exactly as move leaves it, '.' on
+   the path if there is one and '!' on every cell tried
+   if there isn't.*/
+   public:
+   enum State { running, solved, noPath, cancelled };
+
+   private:
+   struct Frame
+   {
+      int x, y, next;
+   };
+
+   Maze &maze;
+   std::vector<Frame> stack;
+   State state;
+
+   int tryMove(int x, int y)
+   {
+      /*What move(x, y) would do on arriving at x, y.
+      Returns 1 on the finish, 2 if the cell is entered
+      and 0 if it can't be*/
+      if (x < 0 || y < 0)
+      {
+         return 0;
+      }
+
+      MazeRow *mRow = maze.mazeRows.find(y);
+      if (mRow == NULL)
+      {
+         return 0;
+      }
+
+      char c = mRow->searchMazePoint(x);
+      if (c == 'f')
+      {
+         return 1;
+      }
+
+      if (c == ' ' || c == 's')
+      {
+         mRow->changeMazePoint(x, '!');
+
+         Frame frame = { x, y, 0 };
+         stack.push_back(frame);
+         return 2;
+      }
+      return 0;
+   }
+
+   void markPath()
+   {
+      //move cleans up and marks each cell as it returns true
+      maze.cleanUpMaze();
+      for (const Frame &frame : stack)
+      {
+         maze.mazeRows.find(frame.y)->changeMazePoint(frame.x, '.');
+      }
+   }
+
+   public:
+
+   MazeSolveTask(Maze &m) : maze(m)
+   {
+      //the search starts where findPathThroughMaze starts it
+      state = running;
+      int arrived = tryMove(maze.startX, maze.startY);
+
+      if (arrived == 1)
+      {
+         state = solved;
+      }
+      else if (arrived == 0)
+      {
+         state = noPath;
+      }
+   }
+
+   State step(long budget)
+   {
+      /*Try up to budget moves, then return. Keep calling
+      while it returns running.*/
+      static const int dirX[4] = { 0, 0, 1, -1 };
+      static const int dirY[4] = { 1, -1, 0, 0 };
+
+      for (long moves = 0; moves < budget && state == running; moves++)
+      {
+         if (stack.empty())
+         {
+            state = noPath;
+            break;
+         }
+
+         Frame &top = stack.back();
+         if (top.next == 4)
+         {
+            stack.pop_back();
+            continue;
+         }
+
+         int d = top.next++;
+         if (tryMove(top.x + dirX[d], top.y + dirY[d]) == 1)
+         {
+            markPath();
+            state = solved;
+         }
+      }
+      return state;
+   }
+
+   void cancel()
+   {
+      //stop for good and take the breadcrumbs back off the maze
+      if (state == running)
+      {
+         maze.cleanUpMaze();
+         stack.clear();
+         state = cancelled;
+      }
+   }
+
+   State getState() const
+   {
+      return state;
+   }
+};
+
+#endif
@@ -0,0 +1,32 @@
+#ifndef MAZEERROR_H
+#define MAZEERROR_H
+
+#include <stdexcept>
+#include <string>
+
+/********************************************************\
+   a maze that can't be loaded or solved
+
+   what() is the whole message the program prints for
+   it, newlines included. The loaders throw it rather
+   than exiting so main prints it and a caller that
+   loads many mazes, like fuzzmaze, can go on to the
+   next one.
+\********************************************************/
+
+class MazeError : public std::runtime_error
+{
+   public:
+      MazeError(const std::string &message) : std::runtime_error(message)
+      {
+      }
+
+      static MazeError invalidCharacter(int row)
+      {
+         // rows count from 0, the message counts lines from 1
+         return MazeError("Invalid character in maze on line " + 
+                          std::to_string(row + 1) + "\n");
+      }
+};
+
+#endif
@@ -0,0 +1,275 @@
+#ifndef MAZEGRID_H
+#define MAZEGRID_H
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+/********************************************************\
+   flat grid copy of a maze for the grid based solvers
+\********************************************************/
+
+struct GridPoint
+{
+   int x, y;
+
+   GridPoint() : x(0), y(0) {}
+   GridPoint(int px, int py) : x(px), y(py) {}
+};
+
+/********************************************************\
+   cell layouts, map an (x, y) cell to its place in the
+   grid's storage
+\********************************************************/
+
+class RowMajorLayout
+{
+   private:
+      int width;
+
+   public:
+      RowMajorLayout() : width(0)
+      {
+      }
+
+      size_t resize(int w, int h)
+      {
+         // returns the number of cells of storage needed
+         width = w;
+         return (size_t)w * h;
+      }
+
+      size_t index(int x, int y) const
+      {
+         return (size_t)y * width + x;
+      }
+};
+
+template <int tileBits> class TiledLayout
+{
+   /*Cells are grouped into square tiles of 2^tileBits cells
+   a side, stored row by row inside the tile and tile after
+   tile across the maze. With 8 x 8 tiles of chars a tile is
+   one 64 byte cache line, so a step up or down usually stays
+   in the same line instead of jumping a whole row.*/
+   private:
+      int tilesAcross;
+
+      static const int tileSide = 1 << tileBits;
+      static const int tileMask = tileSide - 1;
+
+   public:
+      TiledLayout() : tilesAcross(0)
+      {
+      }
+
+      size_t resize(int w, int h)
+      {
+         tilesAcross = (w + tileMask) >> tileBits;
+         int tilesDown = (h + tileMask) >> tileBits;
+         return ((size_t)tilesAcross * tilesDown) << (2 * tileBits);
+      }
+
+      size_t index(int x, int y) const
+      {
+         size_t tile = (size_t)(y >> tileBits) * tilesAcross + (x >> tileBits);
+         return (tile << (2 * tileBits)) | ((y & tileMask) << tileBits) | (x & tileMask);
+      }
+};
+
+/********************************************************\
+   the grid
+\********************************************************/
+
+template <typename Layout> class basicMazeGrid
+
+{
+   private:
+      // private data ====================================
+      int width, height;
+
+      // cells are placed by the layout, cells past the end of a
+      // short row hold '\0' and are treated as walls
+      Layout layout;
+      std::vector<char> cells;
+      std::vector<int> rowLengths;
+
+   public:
+
+      /********************************************************\
+         constructors
+      \********************************************************/
+
+      basicMazeGrid() : width(0), height(0)
+      {
+      }
+
+      basicMazeGrid(int w, int h)
+      {
+         resize(w, h);
+      }
+
+      void resize(int w, int h)
+      {
+         width = w;
+         height = h;
+         cells.assign(layout.resize(w, h), '\0');
+         rowLengths.assign(h, 0);
+      }
+
+      void setRow(int y, const std::string &line)
+      {
+         // copy a line of the maze into row y, the grid must
+         // already be wide enough to hold it
+         rowLengths[y] = line.length();
+         for (unsigned int x = 0; x < line.length(); x++)
+         {
+            cells[layout.index(x, y)] = line[x];
+         }
+      }
+
+      /********************************************************\
+         cell access
+      \********************************************************/
+
+      int getWidth() const
+      {
+         return width;
+      }
+
+      int getHeight() const
+      {
+         return height;
+      }
+
+      int rowLength(int y) const
+      {
+         return rowLengths[y];
+      }
+
+      bool inside(int x, int y) const
+      {
+         return (x >= 0 && y >= 0 && x < width && y < height);
+      }
+
+      char getCell(int x, int y) const
+      {
+         if (!inside(x, y)) return '\0';
+         return cells[layout.index(x, y)];
+      }
+
+      void setCell(int x, int y, char c)
+      {
+         cells[layout.index(x, y)] = c;
+      }
+
+      size_t cellIndex(int x, int y) const
+      {
+         // place of a cell in storage, for solver state kept
+         // in the same layout as the cells
+         return layout.index(x, y);
+      }
+
+      size_t storageSize() const
+      {
+         return cells.size();
+      }
+
+      size_t memoryUsed() const
+      {
+         return cells.capacity() + rowLengths.capacity() * sizeof(int);
+      }
+
+      bool isOpen(int x, int y) const
+      {
+         // same cells the tree solver is allowed to step on
+         char c = getCell(x, y);
+         return (c == ' ' || c == 's' || c == 'f');
+      }
+
+      int cellCost(int x, int y) const
+      {
+         // cost of stepping onto a cell for the weighted solver,
+         // a digit costs its value, other open cells cost 1 and
+         // anything that can't be walked on is 0
+         char c = getCell(x, y);
+         if (c >= '1' && c <= '9') return c - '0';
+         if (c == ' ' || c == 's' || c == 'f') return 1;
+         return 0;
+      }
+
+      bool findCell(char c, int &cx, int &cy) const
+      {
+         // find the first cell holding c, scanning row by row
+         for (int y = 0; y < height; y++)
+         {
+            for (int x = 0; x < rowLengths[y]; x++)
+            {
+               if (cells[layout.index(x, y)] == c)
+               {
+                  cx = x;
+                  cy = y;
+                  return true;
+               }
+            }
+         }
+         return false;
+      }
+
+      void findCells(char c, std::vector<GridPoint> &found) const
+      {
+         // every cell holding c, row by row
+         found.clear();
+         for (int y = 0; y < height; y++)
+         {
+            for (int x = 0; x < rowLengths[y]; x++)
+            {
+               if (cells[layout.index(x, y)] == c)
+               {
+                  found.push_back(GridPoint(x, y));
+               }
+            }
+         }
+      }
+
+      /********************************************************\
+         path marking and output
+      \********************************************************/
+
+      void markPath(const std::vector<GridPoint> &path)
+      {
+         // mark the path with '.' leaving the start and finish alone
+         for (unsigned int i = 0; i < path.size(); i++)
+         {
+            char c = getCell(path[i].x, path[i].y);
+            if (c != 's' && c != 'f')
+            {
+               setCell(path[i].x, path[i].y, '.');
+            }
+         }
+      }
+
+      std::string rowToString(int y) const
+      {
+         std::string line(rowLengths[y], ' ');
+         for (int x = 0; x < rowLengths[y]; x++)
+         {
+            line[x] = cells[layout.index(x, y)];
+         }
+         return line;
+      }
+
+      void print() const
+      {
+         // same output as Maze::printMaze
+         for (int y = 0; y < height; y++)
+         {
+            std::cout << rowToString(y) << "\n";
+         }
+      }
+};
+
+typedef basicMazeGrid<RowMajorLayout> MazeGrid;
+typedef basicMazeGrid< TiledLayout<3> > TiledMazeGrid;
+
+#endif
@@ -0,0 +1,185 @@
+#ifndef MEMSTATS_H
+#define MEMSTATS_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include <sys/resource.h>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#if defined(__GLIBC__)
+#include <malloc.h>
+#endif
+
+/********************************************************\
+   memory accounting for -memstats
+
+   Each structure a solve keeps adds its bytes to the
+   report, which prints them as bytes per maze cell.
+   The sizes are what the structures hold themselves,
+   the heap line from the allocator also counts its own
+   overhead on every block and the peak resident size
+   counts everything, the program included.
+\********************************************************/
+
+class MemoryReport
+{
+   private:
+      // private data ====================================
+      struct Item
+      {
+         std::string name;
+         size_t bytes;
+      };
+
+      std::vector<Item> items;
+      size_t numCells;
+
+      // private functions ===============================
+
+      void printLine(std::ostream &out, const char *name, size_t bytes) const
+      {
+         char line[96];
+         if (numCells > 0)
+         {
+            snprintf(line, sizeof(line), "   %-16s %14zu bytes %10.2f per cell\n",
+                     name, bytes, (double)bytes / numCells);
+         }
+         else
+         {
+            snprintf(line, sizeof(line), "   %-16s %14zu bytes\n", name, bytes);
+         }
+         out << line;
+      }
+
+      static size_t heapInUse()
+      {
+         // 0 where the allocator can't say
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || __GLIBC_MINOR__ >= 33)
+         struct mallinfo2 info = mallinfo2();
+         return info.uordblks + info.hblkhd;
+#else
+         return 0;
+#endif
+      }
+
+   public:
+
+      /********************************************************\
+         constructor
+      \********************************************************/
+
+      MemoryReport() : numCells(0)
+      {
+      }
+
+      /********************************************************\
+         report functions
+      \********************************************************/
+
+      void setCells(size_t cells)
+      {
+         numCells = cells;
+      }
+
+      void add(const std::string &name, size_t bytes)
+      {
+         Item item = { name, bytes };
+         items.push_back(item);
+      }
+
+      size_t total() const
+      {
+         size_t bytes = 0;
+         for (unsigned int i = 0; i < items.size(); i++)
+         {
+            bytes += items[i].bytes;
+         }
+         return bytes;
+      }
+
+      static size_t peakResident()
+      {
+         // the most the process has held at once, so far
+         struct rusage usage;
+         if (getrusage(RUSAGE_SELF, &usage) != 0) return 0;
+         return (size_t)usage.ru_maxrss * 1024;
+      }
+
+      double bytesPerCell() const
+      {
+         // 0 until setCells has been called
+         if (numCells == 0) return 0;
+         return (double)total() / numCells;
+      }
+
+      void print(std::ostream &out) const
+      {
+         /*Call it while the structures are still alive, the
+         heap line is what is allocated at the time*/
+         if (numCells > 0)
+         {
+            out << "Memory for " << numCells << " cells\n";
+         }
+         else
+         {
+            out << "Memory\n";
+         }
+
+         for (unsigned int i = 0; i < items.size(); i++)
+         {
+            printLine(out, items[i].name.c_str(), items[i].bytes);
+         }
+         printLine(out, "total", total());
+
+         size_t heap = heapInUse();
+         if (heap > 0)
+         {
+            printLine(out, "heap in use", heap);
+         }
+         printLine(out, "peak resident", peakResident());
+      }
+};
+
+/********************************************************\
+   how deep a recursive search's stack goes
+
+   A tracer like NullTracer. The address of a local on
+   each enter shows how far down the stack the search
+   has got.
+\********************************************************/
+
+class StackTracer
+{
+   private:
+      uintptr_t base, deepest;
+
+      static uintptr_t here()
+      {
+         char local;
+         return (uintptr_t)&local;
+      }
+
+   public:
+      StackTracer() : base(here()), deepest(base)
+      {
+      }
+
+      void enter(int, int)
+      {
+         uintptr_t address = here();
+         if (address < deepest) deepest = address;
+      }
+
+      void backtrack(int, int) {}
+      void path(int, int) {}
+
+      size_t peakBytes() const
+      {
+         // the stack grows down
+         return base - deepest;
+      }
+};
+
+#endif
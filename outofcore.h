@@ -0,0 +1,996 @@
+#ifndef OUTOFCORE_H
+#define OUTOFCORE_H
+
+#include <stdint.h>
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "mazeerror.h"
+#include "memstats.h"
+#include "radixheap.h"
+#include "rowscan.h"
+
+/********************************************************\
+   out of core solver for mazes bigger than memory
+
+   The maze stays on disk and is worked on in horizontal
+   bands of rows sized to fit a memory budget. A path can
+   only go from one band to the next through an open cell
+   on the band's edge with an open cell across from it,
+   those cells and the start and finish are the nodes of
+   a boundary graph. The first pass runs one breadth
+   first search from all of a band's nodes at once, each
+   cell going to the node it is nearest, and where the
+   cells of two nodes meet there is an edge between them.
+   Each node's cells join up, so the edges are those of
+   a map drawn on paper, no more than three a node.
+
+   An edge is a real way between its nodes but not
+   always the shortest, a shortest way can go through a
+   third node's cells without going through the node. So
+   Dijkstra's search on the graph only gives each node an
+   upper bound on its distance from the start. The bands
+   are then settled one at a time, the band's nodes seed
+   a search with the distances they have, any node that
+   comes out nearer is lowered and the graph search goes
+   on from it. That repeats until no band has had a node
+   in it or across from it lowered since it was settled,
+   at which point every distance is exact and settling
+   has also found where the walk back from each node
+   leaves its band, which strings the path together node
+   to node. The last pass marks the path as it prints
+   each band.
+\********************************************************/
+
+class OutOfCoreMaze
+{
+   private:
+      // private data ====================================
+      // an enum so they can be passed by reference to assign
+      // without needing a definition outside the class
+      enum : uint32_t
+      {
+         unreached = 0xFFFFFFFFu,
+         noNode = 0xFFFFFFFFu,
+         unknownExit = 0xFFFFFFFEu
+      };
+      static const size_t noCell = (size_t)-1;
+
+      // band cell flag
+      static const unsigned char pathFlag = 1;
+
+      struct Edge
+      {
+         uint32_t to, length;
+      };
+
+      // a way between two of a band's nodes found where their
+      // cells meet, from is the lower node
+      struct Link
+      {
+         uint32_t from, to, length;
+
+         bool operator < (const Link &other) const
+         {
+            if (from != other.from) return from < other.from;
+            if (to != other.to) return to < other.to;
+            return length < other.length;
+         }
+      };
+
+      // a band node and its distance from the start
+      struct Seed
+      {
+         uint32_t dist, cell;
+
+         bool operator < (const Seed &other) const
+         {
+            return dist < other.dist;
+         }
+      };
+
+      // edges a node can have, a map on paper with n places
+      // has at most 3n - 6 borders and each edge is kept both
+      // ways round
+      static const size_t maxEdges = 6;
+
+      // memory for each cell of a band, each node of the graph
+      // and each node of the band being worked on. A node's
+      // share of the graph search's heap is a guess.
+      static const size_t bytesPerCell = 2 * sizeof(char) + 3 * sizeof(uint32_t);
+      static const size_t bytesPerNode = sizeof(uint64_t) + sizeof(size_t) +
+                                         5 * sizeof(uint32_t) + sizeof(char) +
+                                         maxEdges * sizeof(Edge) +
+                                         2 * sizeof(std::pair<uint32_t, uint32_t>);
+      static const size_t bytesPerBandNode = maxEdges * sizeof(Link) + sizeof(Seed);
+
+      const char *mazeFile;
+      std::ifstream fin;
+
+      int width, height;
+      std::vector<long long> rowOffsets;
+      std::vector<int> rowLengths;
+
+      // open cells in each row with an open cell below them
+      std::vector<int> openBelow;
+
+      int startX, startY, finishX, finishY;
+      int numStart, numFinish;
+      int startFirstWall, startLastWall, finishFirstWall, finishLastWall;
+
+      // the current band plus one halo row above and below it,
+      // the queue holds the exits of the cells once the
+      // distances are worked out
+      size_t memoryBudget;
+      int rowsPerBand;
+      int bandHeight, bandTop, bandRows;
+      std::vector<char> bandCells;
+      std::vector<uint32_t> bandDist;
+      std::vector<unsigned char> bandFlags;
+      std::vector<uint32_t> queue;
+
+      // the node each cell of the band was reached from, and
+      // while the graph is built the links found so far, which
+      // never grow past linkRoom
+      std::vector<uint32_t> bandOwner;
+      std::vector<Link> links;
+      size_t linkRoom;
+
+      // the boundary graph, nodes are numbered in maze order
+      // and a node's edges run from edgeStart[node] up to
+      // edgeStart[node + 1]. Steps across a band edge aren't
+      // kept, the node across is looked up.
+      std::vector<uint64_t> nodeCells;
+      std::vector<size_t> edgeStart;
+      std::vector<Edge> edges;
+      std::vector<uint32_t> nodeDist;
+      std::vector<uint32_t> nodeExit;
+      std::vector<char> nodeOnPath;
+      uint32_t startNode, finishNode;
+      bool solved;
+
+      // the last settling of each band leaves every node it got
+      // to with the node whose distance got there first and the
+      // length of the way from it. Those are kept as lists of the
+      // nodes each node got to first, they join the edges in
+      // the graph search.
+      std::vector<uint32_t> firstReached, nextReached, reachedLength;
+
+      // bands that need settling again, a node in them or in
+      // their halo rows has been lowered since they last were
+      std::vector<char> bandUnsettled;
+
+      // bytes of the graph search's heap, the most a band's
+      // seeds took and the most a band's links took
+      size_t heapBytes, seedBytes, linkBytes;
+
+      // private functions ===============================
+
+      void unableToLoad(const std::string &reason = "")
+      {
+         throw MazeError(reason + "Unable to load maze " + mazeFile + "\n");
+      }
+
+      static bool validChar(char c)
+      {
+         return (c == '#' || c == ' ' || c == 's' || c == 'f' || c == '\n');
+      }
+
+      static bool isOpen(char c)
+      {
+         return (c == ' ' || c == 's' || c == 'f');
+      }
+
+      size_t local(int x, int y) const
+      {
+         // index into the band buffers, y may be a halo row
+         return (size_t)(y - bandTop + 1) * width + x;
+      }
+
+      uint64_t cellKey(int x, int y) const
+      {
+         return (uint64_t)y * width + x;
+      }
+
+      bool inBand(int y) const
+      {
+         return (y >= bandTop && y < bandTop + bandRows);
+      }
+
+      bool inBandCell(size_t cell) const
+      {
+         // false for the halo rows
+         return (cell >= (size_t)width && cell < (size_t)(bandRows + 1) * width);
+      }
+
+      uint32_t findNode(int x, int y) const
+      {
+         if (y < 0 || y >= height) return noNode;
+
+         uint64_t key = cellKey(x, y);
+         std::vector<uint64_t>::const_iterator found =
+            std::lower_bound(nodeCells.begin(), nodeCells.end(), key);
+         if (found == nodeCells.end() || *found != key) return noNode;
+         return found - nodeCells.begin();
+      }
+
+      uint32_t findLocalNode(size_t cell) const
+      {
+         return findNode(cell % width, bandTop - 1 + (int)(cell / width));
+      }
+
+      size_t nodeLocal(uint32_t node) const
+      {
+         return local(nodeCells[node] % width, nodeCells[node] / width);
+      }
+
+      void rowNodes(int y, uint32_t &first, uint32_t &last) const
+      {
+         // the nodes in row y are first up to but not including last
+         first = std::lower_bound(nodeCells.begin(), nodeCells.end(),
+                                  cellKey(0, y)) - nodeCells.begin();
+         last = std::lower_bound(nodeCells.begin(), nodeCells.end(),
+                                 cellKey(0, y + 1)) - nodeCells.begin();
+      }
+
+      void bandNodes(uint32_t &first, uint32_t &last) const
+      {
+         first = std::lower_bound(nodeCells.begin(), nodeCells.end(),
+                                  cellKey(0, bandTop)) - nodeCells.begin();
+         last = std::lower_bound(nodeCells.begin(), nodeCells.end(),
+                                 cellKey(0, bandTop + bandRows)) - nodeCells.begin();
+      }
+
+      void neighbours(size_t cell, size_t next[4], bool valid[4]) const
+      {
+         // down, up, right, left inside the band
+         int x = cell % width;
+         next[0] = cell + width;
+         next[1] = cell - width;
+         next[2] = cell + 1;
+         next[3] = cell - 1;
+         valid[0] = inBandCell(next[0]);
+         valid[1] = inBandCell(next[1]);
+         valid[2] = (x + 1 < width);
+         valid[3] = (x > 0);
+      }
+
+      void readRows(int y0, int n, char *cells)
+      {
+         // rows outside the maze and cells past the end of a row are walls
+         std::fill(cells, cells + (size_t)n * width, '#');
+
+         int first = std::max(y0, 0);
+         int last = std::min(y0 + n, height);
+         if (first >= last) return;
+
+         std::string line;
+         fin.clear();
+         fin.seekg(rowOffsets[first]);
+         for (int y = first; y < last && getline(fin, line); y++)
+         {
+            std::copy(line.begin(), line.end(), cells + (size_t)(y - y0) * width);
+         }
+      }
+
+      void loadBand(int band)
+      {
+         bandTop = band * bandHeight;
+         bandRows = std::min(bandHeight, height - bandTop);
+
+         size_t size = (size_t)(bandRows + 2) * width;
+         bandCells.resize(size);
+         bandDist.assign(size, unreached);
+         bandFlags.assign(size, 0);
+
+         // a cell is queued at most once a search, so the queue
+         // never grows past the band and doubles its room
+         queue.reserve(size);
+         readRows(bandTop - 1, bandRows + 2, &bandCells[0]);
+      }
+
+      size_t countNodes(int rows, size_t *mostInBand = NULL) const
+      {
+         /*The most nodes bands of this height can have, two for
+         each open cell above an open cell across a band edge
+         and the start and finish. mostInBand gets the most one
+         band can have.*/
+         size_t nodes = 2, most = 2, above = 0;
+         for (int y = rows - 1; y + 1 < height; y += rows)
+         {
+            nodes += 2 * openBelow[y];
+            most = std::max(most, above + openBelow[y] + 2);
+            above = openBelow[y];
+         }
+         most = std::max(most, above + 2);
+
+         if (mostInBand != NULL) *mostInBand = most;
+         return nodes;
+      }
+
+      void overBudget() const
+      {
+         throw MazeError("Error - maze needs more memory than the budget\n");
+      }
+
+      int chooseBandHeight() const
+      {
+         /*The tallest bands whose buffers and graph fit the
+         budget. Short bands have more edges between them so
+         more nodes, if no height fits the maze can't be
+         solved in the budget.*/
+         size_t fixed = (size_t)height * (sizeof(long long) + 2 * sizeof(int));
+
+         for (int rows = std::max(height, 1); rows >= 1; rows--)
+         {
+            size_t mostInBand;
+            size_t nodes = countNodes(rows, &mostInBand);
+            size_t bytes = fixed + (size_t)(rows + 2) * width * bytesPerCell +
+                           nodes * bytesPerNode + mostInBand * bytesPerBandNode;
+            if (bytes <= memoryBudget) return rows;
+         }
+         overBudget();
+         return 0;
+      }
+
+      void addBandNodes()
+      {
+         // the band's edge cells with an open cell across, then
+         // the start and finish, numbered in maze order
+         std::vector<uint64_t> found;
+         int bottom = bandTop + bandRows - 1;
+         for (int x = 0; x < width; x++)
+         {
+            if (isOpen(bandCells[local(x, bandTop)]) &&
+                  isOpen(bandCells[local(x, bandTop - 1)]))
+            {
+               found.push_back(cellKey(x, bandTop));
+            }
+            if (isOpen(bandCells[local(x, bottom)]) &&
+                  isOpen(bandCells[local(x, bottom + 1)]))
+            {
+               found.push_back(cellKey(x, bottom));
+            }
+         }
+         if (inBand(startY)) found.push_back(cellKey(startX, startY));
+         if (inBand(finishY)) found.push_back(cellKey(finishX, finishY));
+
+         std::sort(found.begin(), found.end());
+         found.erase(std::unique(found.begin(), found.end()), found.end());
+         nodeCells.insert(nodeCells.end(), found.begin(), found.end());
+      }
+
+      void compactLinks()
+      {
+         // only the shortest link between each pair of nodes
+         std::sort(links.begin(), links.end());
+         size_t kept = 0;
+         for (size_t i = 0; i < links.size(); i++)
+         {
+            if (kept == 0 || links[i].from != links[kept - 1].from ||
+                  links[i].to != links[kept - 1].to)
+            {
+               links[kept++] = links[i];
+            }
+         }
+         links.resize(kept);
+      }
+
+      void addLink(uint32_t a, uint32_t b, uint32_t length)
+      {
+         // when links is full it is cut down to one link a pair,
+         // the pairs are bounded so that always makes room
+         if (links.size() == linkRoom)
+         {
+            compactLinks();
+            if (2 * links.size() > linkRoom) overBudget();
+         }
+
+         Link link = { std::min(a, b), std::max(a, b), length };
+         links.push_back(link);
+      }
+
+      void linkBand(uint32_t first, uint32_t last)
+      {
+         /*One breadth first search from all the band's nodes,
+         first up to but not including last, at once. Each cell
+         goes to the node whose search gets there first. A step
+         from a cell of one node to a cell of another is a way
+         between those nodes as long as the two distances and
+         the step, each is noted from the nearer cell or from
+         both if they are as near. The shortest link between
+         each pair of nodes gives the edge, kept both ways
+         round.*/
+         size_t next[4];
+         bool valid[4];
+
+         bandOwner.assign(bandCells.size(), noNode);
+         linkRoom = maxEdges * (last - first);
+         links.clear();
+         links.reserve(linkRoom);
+
+         queue.clear();
+         for (uint32_t node = first; node < last; node++)
+         {
+            size_t cell = nodeLocal(node);
+            bandDist[cell] = 0;
+            bandOwner[cell] = node;
+            queue.push_back(cell);
+         }
+
+         for (size_t head = 0; head < queue.size(); head++)
+         {
+            size_t cell = queue[head];
+            uint32_t d = bandDist[cell];
+            uint32_t owner = bandOwner[cell];
+            neighbours(cell, next, valid);
+
+            for (int n = 0; n < 4; n++)
+            {
+               if (!valid[n] || !isOpen(bandCells[next[n]])) continue;
+
+               uint32_t other = bandOwner[next[n]];
+               if (other == noNode)
+               {
+                  bandDist[next[n]] = d + 1;
+                  bandOwner[next[n]] = owner;
+                  queue.push_back(next[n]);
+               }
+               else if (other != owner && bandDist[next[n]] <= d)
+               {
+                  addLink(owner, other, d + 1 + bandDist[next[n]]);
+               }
+            }
+         }
+
+         compactLinks();
+         if (2 * links.size() > linkRoom) overBudget();
+         size_t numLinks = links.size();
+         for (size_t i = 0; i < numLinks; i++)
+         {
+            Link back = { links[i].to, links[i].from, links[i].length };
+            links.push_back(back);
+         }
+         std::sort(links.begin(), links.end());
+
+         size_t i = 0;
+         for (uint32_t node = first; node < last; node++)
+         {
+            edgeStart.push_back(edges.size());
+            for (; i < links.size() && links[i].from == node; i++)
+            {
+               Edge edge = { links[i].to, links[i].length };
+               edges.push_back(edge);
+            }
+         }
+
+         linkBytes = std::max(linkBytes, links.capacity() * sizeof(Link));
+      }
+
+      void relaxNode(radixHeap<uint32_t> &heap, uint32_t node, uint32_t d)
+      {
+         // lowering a node unsettles its band and the band whose
+         // halo row it is in
+         if (node == noNode || d >= nodeDist[node]) return;
+
+         nodeDist[node] = d;
+         heap.push(d, node);
+
+         int y = nodeCells[node] / width;
+         int band = y / bandHeight;
+         bandUnsettled[band] = 1;
+         if (y % bandHeight == 0 && band > 0)
+         {
+            bandUnsettled[band - 1] = 1;
+         }
+         if ((y + 1) % bandHeight == 0 && band + 1 < (int)bandUnsettled.size())
+         {
+            bandUnsettled[band + 1] = 1;
+         }
+      }
+
+      void searchGraph(radixHeap<uint32_t> &heap)
+      {
+         // Dijkstra's search over the boundary graph on from the
+         // nodes in the heap, which is left empty for any keys
+         while (!heap.empty())
+         {
+            uint32_t d, node;
+            heap.pop(d, node);
+            if (d > nodeDist[node]) continue;
+
+            for (size_t e = edgeStart[node]; e < edgeStart[node + 1]; e++)
+            {
+               relaxNode(heap, edges[e].to, d + edges[e].length);
+            }
+            for (uint32_t n = firstReached[node]; n != noNode; n = nextReached[n])
+            {
+               relaxNode(heap, n, d + reachedLength[n]);
+            }
+
+            // steps across to the bands above and below
+            int x = nodeCells[node] % width;
+            int y = nodeCells[node] / width;
+            if (y % bandHeight == 0)
+            {
+               relaxNode(heap, findNode(x, y - 1), d + 1);
+            }
+            if ((y + 1) % bandHeight == 0)
+            {
+               relaxNode(heap, findNode(x, y + 1), d + 1);
+            }
+         }
+         heapBytes = std::max(heapBytes, heap.memoryUsed());
+         heap.clear();
+      }
+
+      void relaxBand()
+      {
+         /*Distances from the start of every cell in the band. A
+         shortest path comes into the band for the last time
+         through one of its nodes, or begins there, so the
+         band's nodes seed it with the distances they have so
+         far. The seeds are sorted and merged with a plain
+         queue, with every step costing 1 the queue stays in
+         order so this is Dijkstra without a heap. Each cell
+         notes the node whose distance got to it. The halo rows
+         get the distances of the nodes across, the walk back
+         looks at them.*/
+         uint32_t first, last;
+         std::vector<Seed> seeds;
+         bandOwner.resize(bandCells.size());
+         bandNodes(first, last);
+         for (uint32_t node = first; node < last; node++)
+         {
+            if (nodeDist[node] == unreached) continue;
+
+            Seed seed;
+            seed.dist = nodeDist[node];
+            seed.cell = nodeLocal(node);
+            bandDist[seed.cell] = seed.dist;
+            bandOwner[seed.cell] = node;
+            seeds.push_back(seed);
+         }
+         std::sort(seeds.begin(), seeds.end());
+         seedBytes = std::max(seedBytes, seeds.capacity() * sizeof(Seed));
+
+         int haloRows[2] = { bandTop - 1, bandTop + bandRows };
+         for (int i = 0; i < 2; i++)
+         {
+            if (haloRows[i] < 0 || haloRows[i] >= height) continue;
+            rowNodes(haloRows[i], first, last);
+            for (uint32_t node = first; node < last; node++)
+            {
+               bandDist[nodeLocal(node)] = nodeDist[node];
+            }
+         }
+
+         size_t next[4];
+         bool valid[4];
+         queue.clear();
+         size_t head = 0, nextSeed = 0;
+         while (head < queue.size() || nextSeed < seeds.size())
+         {
+            uint32_t cell;
+            if (head < queue.size() && (nextSeed == seeds.size() ||
+                  bandDist[queue[head]] <= seeds[nextSeed].dist))
+            {
+               cell = queue[head++];
+            }
+            else
+            {
+               cell = seeds[nextSeed++].cell;
+               if (bandDist[cell] < seeds[nextSeed - 1].dist) continue;
+            }
+
+            uint32_t d = bandDist[cell] + 1;
+            neighbours(cell, next, valid);
+            for (int n = 0; n < 4; n++)
+            {
+               if (!valid[n] || !isOpen(bandCells[next[n]])) continue;
+               if (d < bandDist[next[n]])
+               {
+                  bandDist[next[n]] = d;
+                  bandOwner[next[n]] = bandOwner[cell];
+                  queue.push_back(next[n]);
+               }
+            }
+         }
+      }
+
+      size_t stepBack(size_t cell) const
+      {
+         // the first of down, up, right, left one step nearer the
+         // start, it can be in a halo row. noCell if there's none
+         static const int dirX[4] = { 0, 0, 1, -1 };
+         static const int dirY[4] = { 1, -1, 0, 0 };
+
+         uint32_t d = bandDist[cell];
+         int x = cell % width;
+         for (int n = 0; n < 4; n++)
+         {
+            int nx = x + dirX[n];
+            if (nx < 0 || nx >= width) continue;
+
+            size_t next = cell + (long)dirY[n] * width + dirX[n];
+            if (bandDist[next] == d - 1 && isOpen(bandCells[next])) return next;
+         }
+         return noCell;
+      }
+
+      uint32_t exitFrom(size_t cell) const
+      {
+         // the node the walk back from cell goes on to, the one
+         // across a band edge or the start. unknownExit if the
+         // walk reaches a cell whose exit isn't known yet
+         while (true)
+         {
+            if (queue[cell] != unknownExit) return queue[cell];
+
+            size_t next = stepBack(cell);
+            if (next == noCell) return noNode;
+            if (!inBandCell(next)) return findLocalNode(next);
+            if (bandDist[next] == 0) return startNode;
+            cell = next;
+         }
+      }
+
+      void findExits()
+      {
+         /*Where the walk back from each of the band's nodes
+         leaves the band. Walks that meet go the same way from
+         there, so each cell keeps its exit in the queue and
+         is only walked once.*/
+         uint32_t first, last;
+         bandNodes(first, last);
+         queue.assign(bandCells.size(), unknownExit);
+
+         for (uint32_t node = first; node < last; node++)
+         {
+            if (nodeDist[node] == unreached || node == startNode) continue;
+
+            size_t cell = nodeLocal(node);
+            uint32_t exit = exitFrom(cell);
+            nodeExit[node] = exit;
+
+            // walk it again to note the exit on the way
+            while (cell != noCell && queue[cell] == unknownExit)
+            {
+               queue[cell] = exit;
+               cell = stepBack(cell);
+               if (cell != noCell && (!inBandCell(cell) || bandDist[cell] == 0))
+               {
+                  cell = noCell;
+               }
+            }
+         }
+      }
+
+      void settleBand(radixHeap<uint32_t> &heap)
+      {
+         /*Any of the band's nodes that relaxBand finds nearer the
+         start are lowered, with the nodes across from them, and
+         pushed on heap for the graph search. Lowering the band's
+         own nodes to what relaxBand found doesn't change it so
+         the band is settled, and the exits found now stand
+         unless a later search unsettles it again. The way to
+         each node from the node that got there first is exact,
+         where an edge may not be, so the graph search follows
+         those too.*/
+         int band = bandTop / bandHeight;
+         relaxBand();
+
+         uint32_t first, last;
+         bandNodes(first, last);
+         for (uint32_t node = first; node < last; node++)
+         {
+            firstReached[node] = noNode;
+         }
+         for (uint32_t node = first; node < last; node++)
+         {
+            size_t cell = nodeLocal(node);
+            uint32_t from = bandOwner[cell];
+            if (bandDist[cell] == unreached || from == node) continue;
+
+            nextReached[node] = firstReached[from];
+            firstReached[from] = node;
+            reachedLength[node] = bandDist[cell] - nodeDist[from];
+         }
+
+         for (uint32_t node = first; node < last; node++)
+         {
+            uint32_t d = bandDist[nodeLocal(node)];
+            if (d == unreached) continue;
+
+            relaxNode(heap, node, d);
+            int x = nodeCells[node] % width;
+            int y = nodeCells[node] / width;
+            if (y == bandTop) relaxNode(heap, findNode(x, y - 1), d + 1);
+            if (y == bandTop + bandRows - 1) relaxNode(heap, findNode(x, y + 1), d + 1);
+         }
+         bandUnsettled[band] = 0;
+
+         findExits();
+      }
+
+      void markBandPath()
+      {
+         // walk back from each node the path comes into the band
+         // by until it leaves, the start and finish stay as they are
+         uint32_t first, last;
+         bandNodes(first, last);
+
+         for (uint32_t node = first; node < last; node++)
+         {
+            if (!nodeOnPath[node]) continue;
+
+            size_t cell = nodeLocal(node);
+            if (node != finishNode) bandFlags[cell] |= pathFlag;
+            while (true)
+            {
+               cell = stepBack(cell);
+               if (cell == noCell || !inBandCell(cell) || bandDist[cell] == 0) break;
+               bandFlags[cell] |= pathFlag;
+            }
+         }
+      }
+
+   public:
+
+      /********************************************************\
+         constructors
+      \********************************************************/
+
+      OutOfCoreMaze(size_t budgetBytes, int bandRowsWanted = 0) : mazeFile(NULL),
+         width(0), height(0), startX(0), startY(0), finishX(0), finishY(0),
+         numStart(0), numFinish(0), startFirstWall(-1), startLastWall(-1),
+         finishFirstWall(-1), finishLastWall(-1), memoryBudget(budgetBytes),
+         rowsPerBand(bandRowsWanted), bandHeight(1), bandTop(0), bandRows(0),
+         linkRoom(0), startNode(noNode), finishNode(noNode), solved(false),
+         heapBytes(0), seedBytes(0), linkBytes(0)
+      {
+         // bandRowsWanted sets the band height instead of the
+         // budget, fuzzmaze uses it to get many small bands
+      }
+
+      /********************************************************\
+         load and check
+      \********************************************************/
+
+      void loadMaze(const char *filename)
+      {
+         /*One pass over the file to check the characters and note
+         where each row starts. Only the row index is kept.*/
+         mazeFile = filename;
+         fin.open(filename);
+         if (!fin) unableToLoad();
+
+         std::string line, above;
+         long long offset = 0;
+         while (getline(fin, line))
+         {
+            for (unsigned int x = 0; x < line.length(); x++)
+            {
+               char c = line[x];
+               if (!validChar(c))
+               {
+                  throw MazeError::invalidCharacter(rowLengths.size());
+               }
+               if (c == 's')
+               {
+                  numStart++;
+                  startX = x;
+                  startY = rowLengths.size();
+               }
+               if (c == 'f')
+               {
+                  numFinish++;
+                  finishX = x;
+                  finishY = rowLengths.size();
+               }
+            }
+            if (startY == (int)rowLengths.size())
+            {
+               findWalls(line.data(), line.length(), startFirstWall, startLastWall);
+            }
+            if (finishY == (int)rowLengths.size())
+            {
+               findWalls(line.data(), line.length(), finishFirstWall, finishLastWall);
+            }
+
+            if (!rowLengths.empty())
+            {
+               size_t common = std::min(line.length(), above.length());
+               for (size_t x = 0; x < common; x++)
+               {
+                  if (isOpen(line[x]) && isOpen(above[x])) openBelow.back()++;
+               }
+            }
+            openBelow.push_back(0);
+            above.swap(line);
+
+            rowOffsets.push_back(offset);
+            rowLengths.push_back(above.length());
+            offset += above.length() + 1;
+            if ((int)above.length() > width) width = above.length();
+         }
+         height = rowLengths.size();
+      }
+
+      void checkMaze()
+      {
+         // same checks and messages as Maze::checkMaze
+         if (numStart > 0 && (startFirstWall < 0 || startX < startFirstWall ||
+               startX > startLastWall))
+         {
+            unableToLoad("Error - start declared outside of maze\n");
+         }
+         if (numFinish > 0 && (finishFirstWall < 0 || finishX < finishFirstWall ||
+               finishX > finishLastWall))
+         {
+            unableToLoad("Error - finish declared outside of maze\n");
+         }
+         if (numStart != 1)
+         {
+            throw MazeError(std::string("Error - ") + (numStart == 0 ? "no" : "multiple") +
+                            " start found in maze\n");
+         }
+         if (numFinish != 1)
+         {
+            throw MazeError(std::string("Error - ") + (numFinish == 0 ? "no" : "multiple") +
+                            " finish found in maze\n");
+         }
+      }
+
+      /********************************************************\
+         solve
+      \********************************************************/
+
+      bool solve()
+      {
+         /*Build the boundary graph a band at a time, search it,
+         settle the bands and then find the way the path goes
+         from node to node. Returns false if the finish can't
+         be reached.*/
+         bandHeight = (rowsPerBand > 0) ? rowsPerBand : chooseBandHeight();
+         bandHeight = std::min(bandHeight, std::max(height, 1));
+         int numBands = (height + bandHeight - 1) / bandHeight;
+
+         // each band's edges are bounded, so the graph gets all
+         // its room now and never has to be copied to grow
+         size_t numNodes = countNodes(bandHeight);
+         nodeCells.clear();
+         edgeStart.clear();
+         edges.clear();
+         nodeCells.reserve(numNodes);
+         edgeStart.reserve(numNodes + 1);
+         edges.reserve(maxEdges * numNodes);
+         for (int band = 0; band < numBands; band++)
+         {
+            loadBand(band);
+            uint32_t first = nodeCells.size();
+            addBandNodes();
+            linkBand(first, nodeCells.size());
+         }
+         edgeStart.push_back(edges.size());
+         std::vector<Link>().swap(links);
+         firstReached.assign(nodeCells.size(), noNode);
+         nextReached.assign(nodeCells.size(), noNode);
+         reachedLength.assign(nodeCells.size(), 0);
+
+         startNode = findNode(startX, startY);
+         finishNode = findNode(finishX, finishY);
+         nodeDist.assign(nodeCells.size(), unreached);
+         bandUnsettled.assign(numBands, 0);
+         radixHeap<uint32_t> heap;
+         relaxNode(heap, startNode, 0);
+         searchGraph(heap);
+
+         // the graph keeps every way there is, only not always
+         // at its shortest
+         if (nodeDist[finishNode] == unreached) return false;
+
+         // settle down the maze and back up in turn, a path that
+         // winds back can need more than one go
+         nodeExit.assign(nodeCells.size(), noNode);
+         bool down = true;
+         while (std::find(bandUnsettled.begin(), bandUnsettled.end(), 1) != bandUnsettled.end())
+         {
+            for (int i = 0; i < numBands; i++)
+            {
+               int band = down ? i : numBands - 1 - i;
+               if (!bandUnsettled[band]) continue;
+
+               loadBand(band);
+               settleBand(heap);
+            }
+            searchGraph(heap);
+            down = !down;
+         }
+
+         // follow the exits from the finish back to the start
+         nodeOnPath.assign(nodeCells.size(), 0);
+         uint32_t node = finishNode;
+         for (size_t steps = 0; node != startNode; steps++)
+         {
+            if (node >= nodeCells.size() || steps > nodeCells.size())
+            {
+               throw MazeError("Error - path through the bands is broken\n");
+            }
+            nodeOnPath[node] = 1;
+            node = nodeExit[node];
+         }
+
+         solved = true;
+         return true;
+      }
+
+      /********************************************************\
+         output
+      \********************************************************/
+
+      void printMaze()
+      {
+         // stream the maze back out a band at a time with the path
+         // marked, the same output as Maze::printMaze
+         if (!solved)
+         {
+            std::string line;
+            fin.clear();
+            fin.seekg(0);
+            for (int y = 0; y < height && getline(fin, line); y++)
+            {
+               std::cout << line << "\n";
+            }
+            return;
+         }
+
+         int numBands = (height + bandHeight - 1) / bandHeight;
+         for (int band = 0; band < numBands; band++)
+         {
+            loadBand(band);
+            relaxBand();
+            markBandPath();
+
+            for (int y = bandTop; y < bandTop + bandRows; y++)
+            {
+               std::string line(&bandCells[local(0, y)], rowLengths[y]);
+               for (int x = 0; x < rowLengths[y]; x++)
+               {
+                  if ((bandFlags[local(x, y)] & pathFlag) && line[x] == ' ') line[x] = '.';
+               }
+               std::cout << line << "\n";
+            }
+         }
+      }
+
+      void reportMemory(MemoryReport &report) const
+      {
+         // what is held at the end, the band buffers keep the
+         // room of the biggest band loaded
+         size_t numCells = 0;
+         for (int y = 0; y < height; y++)
+         {
+            numCells += rowLengths[y];
+         }
+
+         report.setCells(numCells);
+         report.add("row index", rowOffsets.capacity() * sizeof(long long) +
+                    (rowLengths.capacity() + openBelow.capacity()) * sizeof(int));
+         report.add("band", bandCells.capacity() + bandFlags.capacity() +
+                    (bandDist.capacity() + queue.capacity() + bandOwner.capacity()) *
+                    sizeof(uint32_t));
+         report.add("graph", nodeCells.capacity() * sizeof(uint64_t) +
+                    edgeStart.capacity() * sizeof(size_t) + edges.capacity() * sizeof(Edge) +
+                    (nodeDist.capacity() + nodeExit.capacity()) * sizeof(uint32_t) +
+                    (firstReached.capacity() + nextReached.capacity() +
+                     reachedLength.capacity()) * sizeof(uint32_t) +
+                    nodeOnPath.capacity() + bandUnsettled.capacity());
+         report.add("solver", heapBytes + seedBytes + linkBytes);
+      }
+};
+
+#endif
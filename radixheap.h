@@ -0,0 +1,135 @@
+#ifndef RADIXHEAP_H
+#define RADIXHEAP_H
+
+#include <stdint.h>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+/********************************************************\
+   radix heap, a priority queue for integer keys that
+   never go below the last key popped
+
+   That always holds in Dijkstra's search, so it can use
+   one. Bucket i holds the keys that first differ from
+   the last key popped at bit i - 1, and bucket 0 holds
+   the keys equal to it. Popping empties the lowest
+   bucket that has items into the buckets below it, and
+   each item can only move down, so a push and a pop cost
+   O(log C) amortised for keys up to C. With small
+   weights most items never move at all.
+\********************************************************/
+
+template <typename valueType> class radixHeap
+{
+   private:
+      typedef std::pair<uint32_t, valueType> item;
+
+      static const int numBuckets = 33;
+
+      // private data ====================================
+      std::vector<item> buckets[numBuckets];
+      uint32_t last;
+      size_t count;
+
+      // private functions ===============================
+
+      int bucketFor(uint32_t key) const
+      {
+         if (key == last) return 0;
+         return 32 - __builtin_clz(key ^ last);
+      }
+
+      void refill()
+      {
+         // bucket 0 is empty, make the smallest key in the lowest
+         // full bucket the new last key and share that bucket out
+         int i = 1;
+         while (buckets[i].empty()) i++;
+
+         std::vector<item> &from = buckets[i];
+         uint32_t smallest = from[0].first;
+         for (size_t k = 1; k < from.size(); k++)
+         {
+            if (from[k].first < smallest) smallest = from[k].first;
+         }
+
+         last = smallest;
+         for (size_t k = 0; k < from.size(); k++)
+         {
+            buckets[bucketFor(from[k].first)].push_back(from[k]);
+         }
+         from.clear();
+      }
+
+   public:
+
+      /********************************************************\
+         constructor
+      \********************************************************/
+
+      radixHeap() : last(0), count(0)
+      {
+      }
+
+      /********************************************************\
+         heap functions
+      \********************************************************/
+
+      bool empty() const
+      {
+         return (count == 0);
+      }
+
+      size_t size() const
+      {
+         return count;
+      }
+
+      size_t memoryUsed() const
+      {
+         // buckets keep their room once emptied, so this is the
+         // most they have held at once or near it
+         size_t bytes = 0;
+         for (int i = 0; i < numBuckets; i++)
+         {
+            bytes += buckets[i].capacity() * sizeof(item);
+         }
+         return bytes;
+      }
+
+      void push(uint32_t key, const valueType &value)
+      {
+         if (key < last)
+         {
+            throw std::invalid_argument("key less than last key popped");
+         }
+
+         buckets[bucketFor(key)].push_back(item(key, value));
+         count++;
+      }
+
+      void pop(uint32_t &key, valueType &value)
+      {
+         // takes out an item with the smallest key, the heap must
+         // not be empty
+         if (buckets[0].empty()) refill();
+
+         key = buckets[0].back().first;
+         value = buckets[0].back().second;
+         buckets[0].pop_back();
+         count--;
+      }
+
+      void clear()
+      {
+         for (int i = 0; i < numBuckets; i++)
+         {
+            buckets[i].clear();
+         }
+         last = 0;
+         count = 0;
+      }
+};
+
+#endif
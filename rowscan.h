@@ -0,0 +1,76 @@
+#ifndef ROWSCAN_H
+#define ROWSCAN_H
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+/********************************************************\
+   finds the first and last wall in a line of a maze
+
+   Everything left of the first wall or right of the last
+   one is outside the maze, and a line with no wall at all
+   is outside everywhere. With SSE2 the line is compared
+   16 chars at a time, otherwise one at a time.
+\********************************************************/
+
+inline void findWalls(const char *line, int length, int &firstWall, int &lastWall)
+{
+   // both are -1 if the line has no wall
+   firstWall = -1;
+   lastWall = -1;
+
+   int i = 0;
+#ifdef __SSE2__
+   const __m128i wall = _mm_set1_epi8('#');
+
+   for (; i + 16 <= length; i += 16)
+   {
+      __m128i chars = _mm_loadu_si128((const __m128i *)(line + i));
+      int mask = _mm_movemask_epi8(_mm_cmpeq_epi8(chars, wall));
+      if (mask != 0)
+      {
+         firstWall = i + __builtin_ctz(mask);
+         break;
+      }
+   }
+#endif
+   if (firstWall < 0)
+   {
+      for (; i < length; i++)
+      {
+         if (line[i] == '#')
+         {
+            firstWall = i;
+            break;
+         }
+      }
+      if (firstWall < 0) return;
+   }
+
+   // the last wall is found the same way from the other end,
+   // it can't be before the first
+   int j = length;
+#ifdef __SSE2__
+   for (; j - 16 >= firstWall; j -= 16)
+   {
+      __m128i chars = _mm_loadu_si128((const __m128i *)(line + j - 16));
+      int mask = _mm_movemask_epi8(_mm_cmpeq_epi8(chars, wall));
+      if (mask != 0)
+      {
+         lastWall = j - 16 + 31 - __builtin_clz(mask);
+         return;
+      }
+   }
+#endif
+   for (j--; j >= firstWall; j--)
+   {
+      if (line[j] == '#')
+      {
+         lastWall = j;
+         return;
+      }
+   }
+}
+
+#endif
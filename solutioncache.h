@@ -0,0 +1,475 @@
+#ifndef SOLUTIONCACHE_H
+#define SOLUTIONCACHE_H
+
+#include <errno.h>
+#include <signal.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <dirent.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <utime.h>
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <streambuf>
+#include <string>
+#include <vector>
+
+/********************************************************\
+   on disk cache of solved mazes
+
+   A solution is the exact output of a run, stored in a
+   file named after a 64 bit hash of the raw maze bytes
+   and the solver options. A run being stored is written
+   straight to a file in the cache dir rather than kept
+   in memory, so caching adds no more than a block buffer
+   to what the solver uses. A hit is copied straight to
+   the output without the maze being parsed. Every hit
+   touches the file's modified time, so when the cache
+   grows past its size the files with the oldest times
+   are the least recently used and go first.
+\********************************************************/
+
+/********************************************************\
+   xxHash64, fed a block at a time
+
+   Bytes are taken in 32 byte stripes across four lanes.
+   A stripe split between two calls of update is held
+   back until the rest of it arrives, so a file read in
+   blocks of any size hashes the same as the whole file.
+\********************************************************/
+
+class contentHash
+{
+   private:
+      static const uint64_t prime1 = 11400714785074694791ULL;
+      static const uint64_t prime2 = 14029467366897019727ULL;
+      static const uint64_t prime3 = 1609587929392839161ULL;
+      static const uint64_t prime4 = 9650029242287828579ULL;
+      static const uint64_t prime5 = 2870177450012600261ULL;
+
+      // private data ====================================
+      uint64_t seed;
+      uint64_t lanes[4];
+      uint64_t total;
+      unsigned char stripe[32];
+      size_t stripeUsed;
+
+      // private functions ===============================
+
+      static uint64_t rotate(uint64_t x, int bits)
+      {
+         return (x << bits) | (x >> (64 - bits));
+      }
+
+      static uint64_t read64(const unsigned char *p)
+      {
+         uint64_t x;
+         memcpy(&x, p, 8);
+         return x;
+      }
+
+      static uint32_t read32(const unsigned char *p)
+      {
+         uint32_t x;
+         memcpy(&x, p, 4);
+         return x;
+      }
+
+      static uint64_t round(uint64_t acc, uint64_t input)
+      {
+         acc += input * prime2;
+         acc = rotate(acc, 31);
+         return acc * prime1;
+      }
+
+      static uint64_t mergeRound(uint64_t acc, uint64_t val)
+      {
+         acc ^= round(0, val);
+         return acc * prime1 + prime4;
+      }
+
+      void addStripe(const unsigned char *p)
+      {
+         lanes[0] = round(lanes[0], read64(p));
+         lanes[1] = round(lanes[1], read64(p + 8));
+         lanes[2] = round(lanes[2], read64(p + 16));
+         lanes[3] = round(lanes[3], read64(p + 24));
+      }
+
+   public:
+
+      /********************************************************\
+         constructor
+      \********************************************************/
+
+      contentHash(uint64_t hashSeed = 0) : seed(hashSeed), total(0), stripeUsed(0)
+      {
+         lanes[0] = seed + prime1 + prime2;
+         lanes[1] = seed + prime2;
+         lanes[2] = seed;
+         lanes[3] = seed - prime1;
+      }
+
+      /********************************************************\
+         hash functions
+      \********************************************************/
+
+      void update(const void *data, size_t length)
+      {
+         const unsigned char *p = (const unsigned char *)data;
+         const unsigned char *end = p + length;
+         total += length;
+
+         // finish a stripe left over from the last block
+         if (stripeUsed > 0)
+         {
+            size_t wanted = std::min(length, sizeof(stripe) - stripeUsed);
+            memcpy(stripe + stripeUsed, p, wanted);
+            stripeUsed += wanted;
+            p += wanted;
+            if (stripeUsed < sizeof(stripe)) return;
+
+            addStripe(stripe);
+            stripeUsed = 0;
+         }
+
+         for (; end - p >= 32; p += 32)
+         {
+            addStripe(p);
+         }
+
+         stripeUsed = end - p;
+         memcpy(stripe, p, stripeUsed);
+      }
+
+      uint64_t digest() const
+      {
+         // the lanes are merged, then the bytes short of a
+         // whole stripe are added on
+         uint64_t h;
+         if (total >= 32)
+         {
+            h = rotate(lanes[0], 1) + rotate(lanes[1], 7) + 
+                rotate(lanes[2], 12) + rotate(lanes[3], 18);
+            h = mergeRound(h, lanes[0]);
+            h = mergeRound(h, lanes[1]);
+            h = mergeRound(h, lanes[2]);
+            h = mergeRound(h, lanes[3]);
+         }
+         else
+         {
+            h = seed + prime5;
+         }
+
+         h += total;
+
+         const unsigned char *p = stripe;
+         const unsigned char *end = stripe + stripeUsed;
+         for (; p + 8 <= end; p += 8)
+         {
+            h ^= round(0, read64(p));
+            h = rotate(h, 27) * prime1 + prime4;
+         }
+         if (p + 4 <= end)
+         {
+            h ^= (uint64_t)read32(p) * prime1;
+            h = rotate(h, 23) * prime2 + prime3;
+            p += 4;
+         }
+         for (; p < end; p++)
+         {
+            h ^= (*p) * prime5;
+            h = rotate(h, 11) * prime1;
+         }
+
+         // final mix so every input bit reaches every output bit
+         h ^= h >> 33;
+         h *= prime2;
+         h ^= h >> 29;
+         h *= prime3;
+         h ^= h >> 32;
+         return h;
+      }
+
+      static uint64_t hash64(const void *data, size_t length, uint64_t seed)
+      {
+         contentHash hash(seed);
+         hash.update(data, length);
+         return hash.digest();
+      }
+};
+
+/********************************************************\
+   stream buffer that passes everything on to another
+   buffer and copies it to a second one
+
+   Output is gathered in a block of its own and handed to
+   both buffers a block at a time, so a maze printed a
+   char at a time costs two virtual calls a block rather
+   than two a char.
+\********************************************************/
+
+class teeBuffer : public std::streambuf
+{
+   private:
+      // private data ====================================
+      std::streambuf *out;
+      std::streambuf *copy;
+      bool copyFailed, outFailed;
+      char block[1 << 13];
+
+      // private functions ===============================
+
+      void send(const char *s, std::streamsize n)
+      {
+         if (n == 0) return;
+         if (copy->sputn(s, n) != n) copyFailed = true;
+         if (out->sputn(s, n) != n) outFailed = true;
+      }
+
+      void flushBlock()
+      {
+         send(pbase(), pptr() - pbase());
+         setp(block, block + sizeof(block));
+      }
+
+   protected:
+      int overflow(int c)
+      {
+         flushBlock();
+         if (c == traits_type::eof()) return traits_type::not_eof(c);
+
+         *pptr() = (char)c;
+         pbump(1);
+         return outFailed ? traits_type::eof() : c;
+      }
+
+      std::streamsize xsputn(const char *s, std::streamsize n)
+      {
+         // a write that fits goes in the block, a bigger one
+         // goes straight through after what is already there
+         if (n <= epptr() - pptr())
+         {
+            memcpy(pptr(), s, n);
+            pbump((int)n);
+            return n;
+         }
+
+         flushBlock();
+         if (n < (std::streamsize)sizeof(block))
+         {
+            memcpy(pptr(), s, n);
+            pbump((int)n);
+            return n;
+         }
+
+         send(s, n);
+         return outFailed ? 0 : n;
+      }
+
+      int sync()
+      {
+         flushBlock();
+         if (copy->pubsync() != 0) copyFailed = true;
+         if (out->pubsync() != 0 || outFailed) return -1;
+         return 0;
+      }
+
+   public:
+
+      /********************************************************\
+         constructor and destructor
+      \********************************************************/
+
+      teeBuffer(std::streambuf *buffer, std::streambuf *copyBuffer) : 
+         out(buffer), copy(copyBuffer), copyFailed(false), outFailed(false)
+      {
+         setp(block, block + sizeof(block));
+      }
+
+      ~teeBuffer()
+      {
+         flushBlock();
+      }
+
+      /********************************************************\
+         results
+      \********************************************************/
+
+      bool copied() const
+      {
+         // false once anything failed to reach the copy
+         return !copyFailed;
+      }
+};
+
+/********************************************************\
+   the cache
+\********************************************************/
+
+class SolutionCache
+{
+   private:
+      // private data ====================================
+      std::string dir;
+      size_t maxBytes;
+
+      struct CacheFile
+      {
+         std::string path;
+         size_t size;
+         struct timespec used;
+
+         bool operator < (const CacheFile &other) const
+         {
+            if (used.tv_sec != other.used.tv_sec) return used.tv_sec < other.used.tv_sec;
+            return used.tv_nsec < other.used.tv_nsec;
+         }
+      };
+
+      // private functions ===============================
+
+      std::string pathFor(uint64_t key) const
+      {
+         char name[32];
+         snprintf(name, sizeof(name), "%016llx.sol", (unsigned long long)key);
+         return dir + "/" + name;
+      }
+
+      static bool isCacheFile(const char *name)
+      {
+         // 16 hex digits and .sol, anything else is left alone
+         return strlen(name) == 20 && strcmp(name + 16, ".sol") == 0 &&
+                strspn(name, "0123456789abcdef") == 16;
+      }
+
+      static long tempFileOwner(const char *name)
+      {
+         // the pid in a name from tempPathFor, 0 for any other name
+         size_t length = strlen(name);
+         if (length < 26 || strncmp(name + 16, ".sol.", 5) != 0 ||
+               strcmp(name + length - 4, ".tmp") != 0)
+         {
+            return 0;
+         }
+         std::string pid(name + 21, length - 25);
+         if (strspn(pid.c_str(), "0123456789") != pid.size()) return 0;
+         return atol(pid.c_str());
+      }
+
+      void evict()
+      {
+         // drop the least recently used files until the cache
+         // fits in maxBytes
+         DIR *d = opendir(dir.c_str());
+         if (d == NULL) return;
+
+         std::vector<CacheFile> files;
+         size_t total = 0;
+
+         struct dirent *entry;
+         while ((entry = readdir(d)) != NULL)
+         {
+            // a run that crashed leaves its temporary file behind
+            long owner = tempFileOwner(entry->d_name);
+            if (owner > 0 && kill(owner, 0) != 0 && errno == ESRCH)
+            {
+               remove((dir + "/" + entry->d_name).c_str());
+               continue;
+            }
+            if (!isCacheFile(entry->d_name)) continue;
+
+            CacheFile file;
+            file.path = dir + "/" + entry->d_name;
+
+            struct stat info;
+            if (stat(file.path.c_str(), &info) != 0) continue;
+
+            file.size = info.st_size;
+            file.used = info.st_mtim;
+            total += file.size;
+            files.push_back(file);
+         }
+         closedir(d);
+
+         std::sort(files.begin(), files.end());
+         for (unsigned int i = 0; i < files.size() && total > maxBytes; i++)
+         {
+            if (remove(files[i].path.c_str()) == 0) total -= files[i].size;
+         }
+      }
+
+   public:
+
+      /********************************************************\
+         constructor
+      \********************************************************/
+
+      SolutionCache(const std::string &cacheDir, size_t budgetBytes) :
+         dir(cacheDir), maxBytes(budgetBytes)
+      {
+         mkdir(dir.c_str(), 0755);
+      }
+
+      /********************************************************\
+         cache functions
+      \********************************************************/
+
+      static bool makeKey(const char *mazeFile, const std::string &mode, uint64_t &key)
+      {
+         // the options are hashed first and seed the hash of the
+         // maze, so each mode has its own entry. The file is read
+         // a block at a time, false if it can't be read
+         std::ifstream fin(mazeFile, std::ios::binary);
+         if (!fin) return false;
+
+         contentHash hash(contentHash::hash64(mode.data(), mode.size(), 0));
+         char block[1 << 16];
+         while (fin.read(block, sizeof(block)) || fin.gcount() > 0)
+         {
+            hash.update(block, fin.gcount());
+         }
+         if (fin.bad()) return false;
+
+         key = hash.digest();
+         return true;
+      }
+
+      bool fetch(uint64_t key, std::ostream &out) const
+      {
+         // copy a cached solution to out, false if there is none
+         std::string path = pathFor(key);
+         std::ifstream fin(path.c_str(), std::ios::binary);
+         if (!fin) return false;
+
+         utime(path.c_str(), NULL);
+         if (fin.peek() != EOF) out << fin.rdbuf();
+         return true;
+      }
+
+      std::string tempPathFor(uint64_t key) const
+      {
+         // a name in the cache dir for a solution still being
+         // written, so another run never reads half a file
+         char suffix[32];
+         snprintf(suffix, sizeof(suffix), ".%ld.tmp", (long)getpid());
+         return pathFor(key) + suffix;
+      }
+
+      void store(uint64_t key, const std::string &tmpPath)
+      {
+         // the finished file from tempPathFor is renamed into place
+         if (rename(tmpPath.c_str(), pathFor(key).c_str()) != 0)
+         {
+            remove(tmpPath.c_str());
+            return;
+         }
+         evict();
+      }
+};
+
+#endif
@@ -0,0 +1,265 @@
+#ifndef SOLVERENGINE_H
+#define SOLVERENGINE_H
+
+#include <stdint.h>
+#include <vector>
+
+#include "mazegrid.h"
+
+/********************************************************\
+   depth first search engine built from policies
+
+   The engine is a template over the grid type and three
+   policies, so each combination is compiled into its own
+   search loop with the directions and visited test
+   inlined:
+      Connectivity - which neighbours a cell has
+      Order        - which order they are tried in
+      Visited      - how the visited cells are stored
+   With FourConnected and DownUpRightLeft it follows the
+   same path as Maze::move, without the recursion.
+\********************************************************/
+
+/********************************************************\
+   connectivity policies. Directions 0 to 3 are down, up,
+   right and left, 4 to 7 the diagonals.
+\********************************************************/
+
+struct DirectionTable
+{
+   static int dirX(int d)
+   {
+      static const int x[8] = { 0, 0, 1, -1, 1, -1, 1, -1 };
+      return x[d];
+   }
+
+   static int dirY(int d)
+   {
+      static const int y[8] = { 1, -1, 0, 0, 1, 1, -1, -1 };
+      return y[d];
+   }
+};
+
+struct FourConnected : public DirectionTable
+{
+   static const int numDirs = 4;
+};
+
+struct EightConnected : public DirectionTable
+{
+   // a diagonal step can't cut a corner, both of the cells
+   // beside it have to be open
+   static const int numDirs = 8;
+};
+
+/********************************************************\
+   order policies, the direction tried k-th
+\********************************************************/
+
+struct DownUpRightLeft
+{
+   // the order Maze::move uses
+   static int dir(int k)
+   {
+      return k;
+   }
+};
+
+struct RightDownLeftUp
+{
+   // clockwise from the right, then the diagonals
+   static int dir(int k)
+   {
+      static const int order[8] = { 2, 0, 3, 1, 4, 5, 7, 6 };
+      return order[k];
+   }
+};
+
+/********************************************************\
+   visited policies
+\********************************************************/
+
+class ByteVisited
+{
+   private:
+      std::vector<unsigned char> cells;
+
+   public:
+      void reset(size_t numCells)
+      {
+         cells.assign(numCells, 0);
+      }
+
+      bool test(size_t i) const
+      {
+         return cells[i] != 0;
+      }
+
+      void set(size_t i)
+      {
+         cells[i] = 1;
+      }
+
+      size_t memoryUsed() const
+      {
+         return cells.capacity();
+      }
+};
+
+class BitVisited
+{
+   // an eighth of the memory of ByteVisited for a shift and mask
+   private:
+      std::vector<uint64_t> words;
+
+   public:
+      void reset(size_t numCells)
+      {
+         words.assign((numCells + 63) >> 6, 0);
+      }
+
+      bool test(size_t i) const
+      {
+         return (words[i >> 6] >> (i & 63)) & 1;
+      }
+
+      void set(size_t i)
+      {
+         words[i >> 6] |= 1ULL << (i & 63);
+      }
+
+      size_t memoryUsed() const
+      {
+         return words.capacity() * sizeof(uint64_t);
+      }
+};
+
+/********************************************************\
+   the engine
+\********************************************************/
+
+template <typename GridType, typename Connectivity, typename Order,
+          typename Visited>
+class SolverEngine
+{
+   private:
+      // private data ====================================
+      const GridType &grid;
+      Visited visited;
+
+      // a cell on the search path and the next direction to try
+      struct Frame
+      {
+         GridPoint p;
+         int next;
+
+         Frame(int x, int y) : p(x, y), next(0) {}
+      };
+
+      int startX, startY, finishX, finishY;
+
+      // bytes of the stack the last solve used
+      size_t stackBytes;
+
+      // private functions ===============================
+
+      bool canStep(int x, int y, int d) const
+      {
+         // diagonal steps need both cells beside them open
+         if (d < 4) return true;
+         return grid.isOpen(x + Connectivity::dirX(d), y) &&
+                grid.isOpen(x, y + Connectivity::dirY(d));
+      }
+
+      bool canEnter(int x, int y)
+      {
+         // like Maze::move the start is never marked, so the
+         // search can come back through it
+         if (!grid.isOpen(x, y)) return false;
+         if (x == startX && y == startY) return true;
+
+         size_t cell = grid.cellIndex(x, y);
+         if (visited.test(cell)) return false;
+
+         visited.set(cell);
+         return true;
+      }
+
+   public:
+
+      /********************************************************\
+         constructor
+      \********************************************************/
+
+      SolverEngine(const GridType &mazeGrid) : grid(mazeGrid),
+         startX(0), startY(0), finishX(0), finishY(0), stackBytes(0)
+      {
+      }
+
+      /********************************************************\
+         solve
+      \********************************************************/
+
+      bool solve(int sx, int sy, int fx, int fy, std::vector<GridPoint> &path)
+      {
+         /*Depth first search with an explicit stack. The path is
+         the stack when the finish is stepped on, followed by
+         the finish. Returns false if it can't be reached.*/
+         startX = sx;
+         startY = sy;
+         finishX = fx;
+         finishY = fy;
+
+         path.clear();
+         stackBytes = 0;
+         visited.reset(grid.storageSize());
+         if (!grid.isOpen(startX, startY)) return false;
+
+         std::vector<Frame> stack;
+         stack.push_back(Frame(startX, startY));
+
+         while (!stack.empty())
+         {
+            Frame &top = stack.back();
+            if (top.next == Connectivity::numDirs)
+            {
+               stack.pop_back();
+               continue;
+            }
+
+            int d = Order::dir(top.next++);
+            int x = top.p.x;
+            int y = top.p.y;
+            int nx = x + Connectivity::dirX(d);
+            int ny = y + Connectivity::dirY(d);
+
+            if (!canStep(x, y, d)) continue;
+
+            if (nx == finishX && ny == finishY)
+            {
+               for (unsigned int i = 0; i < stack.size(); i++)
+               {
+                  path.push_back(stack[i].p);
+               }
+               path.push_back(GridPoint(nx, ny));
+               stackBytes = stack.capacity() * sizeof(Frame);
+               return true;
+            }
+
+            if (canEnter(nx, ny))
+            {
+               stack.push_back(Frame(nx, ny));
+            }
+         }
+         stackBytes = stack.capacity() * sizeof(Frame);
+         return false;
+      }
+
+      size_t memoryUsed() const
+      {
+         // the visited marks and the stack of the last solve
+         return visited.memoryUsed() + stackBytes;
+      }
+};
+
+#endif
@@ -0,0 +1,244 @@
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <set>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "concurrentbintree.h"
+
+using namespace std;
+
+/*Stress test for concurrentBintree.
+
+Usage: stressconcurrent [-seconds n] [-readers n] [-writers n]
+
+First one thread runs random inserts and erases against
+a std::set and checks the tree holds the same items in
+order, and that duplicates and missing items throw.
+Then readers and writers share one tree for n seconds,
+2 by default, with 3 readers and 2 writers. The even
+keys are always in the tree and the writers add and take
+out the odd ones. Every reader lookup of an even key has
+to find it, every item found has to be whole, and walks
+of the tree have to be in order. Build it with
+-fsanitize=thread or -fsanitize=address as well to catch
+races and nodes freed too early. Prints ok or the first
+thing that went wrong.*/
+
+// the payload of key k is k * 7 written out
+typedef sharedItem<long, string> Item;
+
+Item makeItem(long key)
+{
+   return Item(key, to_string(key * 7));
+}
+
+bool whole(const Item &item)
+{
+   return item.payload() == to_string(item.key() * 7);
+}
+
+bool failed(const string &what)
+{
+   cout << "Failed: " << what << "\n";
+   return false;
+}
+
+bool inOrder(const concurrentBintree<Item> &tree, long &count)
+{
+   bool ordered = true;
+   long last = -1;
+   count = 0;
+   tree.forEach([&](const Item &item)
+   {
+      if (item.key() <= last || !whole(item)) ordered = false;
+      last = item.key();
+      count++;
+   });
+   return ordered;
+}
+
+bool checkOneThread()
+{
+   concurrentBintree<Item> tree;
+   set<long> expected;
+
+   srand(1);
+   for (int i = 0; i < 300000; i++)
+   {
+      long key = rand() % 3000;
+      if (expected.count(key))
+      {
+         tree.erase(key);
+         expected.erase(key);
+      }
+      else
+      {
+         tree.insert(makeItem(key));
+         expected.insert(key);
+      }
+   }
+
+   long count;
+   if (!inOrder(tree, count) || count != (long)expected.size() ||
+         tree.size() != (int)expected.size())
+   {
+      return failed("one thread, the tree doesn't match a std::set");
+   }
+
+   for (set<long>::iterator it = expected.begin(); it != expected.end(); ++it)
+   {
+      Item item;
+      if (!tree.find(*it, item) || item.key() != *it || !whole(item))
+      {
+         return failed("one thread, an item went missing");
+      }
+   }
+
+   try
+   {
+      tree.insert(makeItem(*expected.begin()));
+      return failed("one thread, a duplicate insert didn't throw");
+   }
+   catch (const invalid_argument &)
+   {
+   }
+
+   try
+   {
+      tree.erase(-5L);
+      return failed("one thread, erasing a missing item didn't throw");
+   }
+   catch (const invalid_argument &)
+   {
+   }
+   return true;
+}
+
+bool checkThreads(int seconds, int numReaders, int numWriters)
+{
+   static const long numKeys = 1 << 16;
+
+   concurrentBintree<Item> tree;
+   for (long key = 0; key < numKeys; key += 2)
+   {
+      tree.insert(makeItem(key));
+   }
+
+   atomic<bool> stop(false);
+   atomic<long> reads(0), writes(0), walks(0), errors(0);
+   vector<thread> threads;
+
+   for (int r = 0; r < numReaders; r++)
+   {
+      threads.push_back(thread([&, r]()
+      {
+         unsigned int seed = r * 77 + 1;
+         long count = 0;
+         while (!stop.load())
+         {
+            seed = seed * 1103515245 + 12345;
+            long key = (seed >> 8) % numKeys;
+            Item item;
+            bool found = tree.find(key, item);
+            if ((key % 2 == 0 && !found) || (found && !whole(item))) errors++;
+
+            // now and then a whole walk of one version
+            if (count % 4096 == 0)
+            {
+               long walked;
+               if (!inOrder(tree, walked) || walked < numKeys / 2) errors++;
+               walks++;
+            }
+            count++;
+         }
+         reads += count;
+      }));
+   }
+
+   for (int w = 0; w < numWriters; w++)
+   {
+      threads.push_back(thread([&, w]()
+      {
+         // two writers can pick the same key, the loser throws
+         unsigned int seed = w * 991 + 3;
+         long count = 0;
+         while (!stop.load())
+         {
+            seed = seed * 1103515245 + 12345;
+            long key = ((seed >> 8) % (numKeys / 2)) * 2 + 1;
+            try
+            {
+               if (tree.contains(key)) tree.erase(key);
+               else tree.insert(makeItem(key));
+            }
+            catch (const invalid_argument &)
+            {
+            }
+            count++;
+         }
+         writes += count;
+      }));
+   }
+
+   this_thread::sleep_for(chrono::seconds(seconds));
+   stop.store(true);
+   for (size_t i = 0; i < threads.size(); i++)
+   {
+      threads[i].join();
+   }
+   tree.synchronize();
+
+   long count;
+   if (!inOrder(tree, count) || count != tree.size())
+   {
+      return failed("threads, the tree is out of order after the run");
+   }
+   if (errors.load() > 0)
+   {
+      return failed("threads, " + to_string(errors.load()) + " bad reads");
+   }
+
+   cout << reads.load() << " reads, " << walks.load() << " walks and "
+        << writes.load() << " writes\n";
+   return true;
+}
+
+int main(int argc, char *argv[])
+{
+   int seconds = 2;
+   int numReaders = 3;
+   int numWriters = 2;
+
+   for (int i = 1; i < argc; i++)
+   {
+      if (strcmp(argv[i], "-seconds") == 0 && i + 1 < argc)
+      {
+         seconds = atoi(argv[++i]);
+      }
+      else if (strcmp(argv[i], "-readers") == 0 && i + 1 < argc)
+      {
+         numReaders = atoi(argv[++i]);
+      }
+      else if (strcmp(argv[i], "-writers") == 0 && i + 1 < argc)
+      {
+         numWriters = atoi(argv[++i]);
+      }
+      else
+      {
+         cout << "Usage: stressconcurrent [-seconds n] [-readers n] [-writers n]\n";
+         return 0;
+      }
+   }
+
+   if (!checkOneThread()) return 1;
+   if (!checkThreads(seconds, numReaders, numWriters)) return 1;
+
+   cout << "ok\n";
+   return 0;
+}
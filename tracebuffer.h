@@ -0,0 +1,108 @@
+#ifndef TRACEBUFFER_H
+#define TRACEBUFFER_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include <vector>
+
+/********************************************************\
+   search trace for debugging how a solver moves
+
+   The solver is a template over a tracer. NullTracer
+   does nothing and inlines away, so an untraced solve
+   is the same code as before. RingTracer packs each
+   event into one 64 bit word written into a ring
+   buffer, when the ring is full the oldest events are
+   written over. The trace file is:
+      magic 'MZTR', version        2 x uint32
+      events recorded, events kept 2 x uint64
+      the events kept, oldest first
+   and tracereplay turns it back into frames.
+\********************************************************/
+
+enum TraceKind
+{
+   traceEnter = 0,      // a breadcrumb '!' is dropped on a cell
+   traceBacktrack = 1,  // every way out of a cell failed
+   tracePath = 2        // the cell is marked '.' on the way back
+};
+
+static const uint32_t traceMagic = 0x52545a4d;
+static const uint32_t traceVersion = 1;
+
+inline uint64_t packTraceEvent(TraceKind kind, int x, int y)
+{
+   // kind in the low 2 bits, then 31 bits each of x and y
+   return (uint64_t)kind | ((uint64_t)(uint32_t)x << 2) | ((uint64_t)(uint32_t)y << 33);
+}
+
+inline void unpackTraceEvent(uint64_t event, TraceKind &kind, int &x, int &y)
+{
+   kind = (TraceKind)(event & 3);
+   x = (int)((event >> 2) & 0x7fffffff);
+   y = (int)(event >> 33);
+}
+
+class NullTracer
+{
+   public:
+      void enter(int, int) {}
+      void backtrack(int, int) {}
+      void path(int, int) {}
+};
+
+class RingTracer
+{
+   private:
+      std::vector<uint64_t> events;
+      uint64_t mask;
+      uint64_t count;
+
+      void record(TraceKind kind, int x, int y)
+      {
+         events[count & mask] = packTraceEvent(kind, x, y);
+         count++;
+      }
+
+   public:
+      RingTracer(int sizeBits) : events((size_t)1 << sizeBits),
+         mask(((uint64_t)1 << sizeBits) - 1), count(0)
+      {
+      }
+
+      void enter(int x, int y)
+      {
+         record(traceEnter, x, y);
+      }
+
+      void backtrack(int x, int y)
+      {
+         record(traceBacktrack, x, y);
+      }
+
+      void path(int x, int y)
+      {
+         record(tracePath, x, y);
+      }
+
+      bool write(const char *filename) const
+      {
+         FILE *fout = fopen(filename, "wb");
+         if (fout == NULL) return false;
+
+         uint64_t kept = (count < events.size()) ? count : events.size();
+         uint32_t header[2] = { traceMagic, traceVersion };
+         uint64_t sizes[2] = { count, kept };
+         fwrite(header, sizeof(header), 1, fout);
+         fwrite(sizes, sizeof(sizes), 1, fout);
+
+         // oldest first, the ring may have wrapped
+         for (uint64_t i = count - kept; i < count; i++)
+         {
+            fwrite(&events[i & mask], sizeof(uint64_t), 1, fout);
+         }
+         return fclose(fout) == 0;
+      }
+};
+
+#endif
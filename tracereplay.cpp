@@ -0,0 +1,188 @@
+#include <iostream>
+#include <fstream>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+#include "tracebuffer.h"
+
+using namespace std;
+
+/*Replays a trace written by assign2 -trace as ASCII frames
+of the maze.
+
+Usage: tracereplay [-every n] mazefile tracefile
+
+A frame is printed every n events, 1 by default, and
+once more at the end. Cells on the search's current
+path show '!' like the breadcrumbs of Maze::move, dead
+ends it has backed out of show '-' and the final path
+shows '.'.*/
+
+void unableToLoad(const char *filename)
+{
+   cout << "Unable to load " << filename << "\n";
+   exit(0);
+}
+
+void loadMaze(const char *filename, vector<string> &rows)
+{
+   string line;
+   ifstream fin(filename);
+   if (!fin)
+   {
+      unableToLoad(filename);
+   }
+
+   while (getline(fin, line))
+   {
+      rows.push_back(line);
+   }
+}
+
+void loadTrace(const char *filename, uint64_t &recorded, vector<uint64_t> &events)
+{
+   FILE *fin = fopen(filename, "rb");
+   if (fin == NULL)
+   {
+      unableToLoad(filename);
+   }
+
+   uint32_t header[2];
+   uint64_t sizes[2];
+   if (fread(header, sizeof(header), 1, fin) != 1 ||
+         header[0] != traceMagic || header[1] != traceVersion ||
+         fread(sizes, sizeof(sizes), 1, fin) != 1)
+   {
+      cout << "Not a maze trace " << filename << "\n";
+      exit(0);
+   }
+
+   recorded = sizes[0];
+   events.resize(sizes[1]);
+   if (!events.empty() &&
+         fread(&events[0], sizeof(uint64_t), events.size(), fin) != events.size())
+   {
+      cout << "Trace " << filename << " is cut short\n";
+      exit(0);
+   }
+   fclose(fin);
+}
+
+void setCell(vector<string> &rows, int x, int y, char c)
+{
+   //the start and finish are never drawn over
+   if (y < 0 || y >= (int)rows.size() || x < 0 || x >= (int)rows[y].length())
+   {
+      return;
+   }
+   if (rows[y][x] != 's' && rows[y][x] != 'f')
+   {
+      rows[y][x] = c;
+   }
+}
+
+void cleanUp(vector<string> &rows)
+{
+   //the first path cell is where move cleaned up the maze
+   for (string &row : rows)
+   {
+      for (char &c : row)
+      {
+         if (c == '!' || c == '-')
+         {
+            c = ' ';
+         }
+      }
+   }
+}
+
+void printFrame(const vector<string> &rows, uint64_t event, uint64_t numEvents)
+{
+   cout << "-- event " << event << " of " << numEvents << " --\n";
+   for (const string &row : rows)
+   {
+      cout << row << "\n";
+   }
+}
+
+int main(int argc, char *argv[])
+{
+   const char *files[2] = { NULL, NULL };
+   int numFiles = 0;
+   long every = 1;
+
+   for (int i = 1; i < argc; i++)
+   {
+      if (strcmp(argv[i], "-every") == 0 && i + 1 < argc)
+      {
+         every = atol(argv[++i]);
+      }
+      else if (numFiles < 2)
+      {
+         files[numFiles++] = argv[i];
+      }
+      else
+      {
+         numFiles = 3;
+         break;
+      }
+   }
+
+   if (numFiles != 2 || every < 1)
+   {
+      cout << "Usage: tracereplay [-every n] mazefile tracefile\n";
+      return 0;
+   }
+
+   vector<string> rows;
+   loadMaze(files[0], rows);
+
+   uint64_t recorded;
+   vector<uint64_t> events;
+   loadTrace(files[1], recorded, events);
+
+   if (recorded > events.size())
+   {
+      //the ring wrapped, cells entered before the first kept
+      //event won't show
+      cout << "-- first " << recorded - events.size()
+           << " events were written over --\n";
+   }
+
+   bool cleaned = false;
+   for (size_t i = 0; i < events.size(); i++)
+   {
+      TraceKind kind;
+      int x, y;
+      unpackTraceEvent(events[i], kind, x, y);
+
+      if (kind == traceEnter)
+      {
+         setCell(rows, x, y, '!');
+      }
+      else if (kind == traceBacktrack)
+      {
+         setCell(rows, x, y, '-');
+      }
+      else
+      {
+         if (!cleaned)
+         {
+            cleanUp(rows);
+            cleaned = true;
+         }
+         setCell(rows, x, y, '.');
+      }
+
+      if ((i + 1) % every == 0 && i + 1 < events.size())
+      {
+         printFrame(rows, i + 1, events.size());
+      }
+   }
+   printFrame(rows, events.size(), events.size());
+
+   return 0;
+}